@@ -0,0 +1,143 @@
+#include <sample_convert.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr size_t kSamples{ 1 << 20 };
+    constexpr auto kMinDuration{ std::chrono::milliseconds(200) };
+
+    using Clock = std::chrono::steady_clock;
+
+    // Throughput in GB/s of float samples, whichever direction they go.
+    template<typename Fn>
+    double measureGbps(Fn&& convert) {
+        convert();
+
+        size_t iterations = 0;
+        const auto start = Clock::now();
+        auto elapsed = Clock::duration{};
+        do {
+            convert();
+            ++iterations;
+            elapsed = Clock::now() - start;
+        } while (elapsed < kMinDuration);
+
+        const double bytes = static_cast<double>(kSamples * sizeof(float) * iterations);
+        return bytes / std::chrono::duration<double>(elapsed).count() / 1e9;
+    }
+
+    void report(const std::string& name, const double baseline, const double current) {
+        std::cout << std::setw(22) << std::left << name << std::right
+                  << std::setw(12) << std::fixed << std::setprecision(2) << baseline
+                  << std::setw(12) << current
+                  << std::setw(10) << std::setprecision(2) << current / baseline << "x\n";
+    }
+
+    // Per-sample conversions as WavFile and wav_format did them before.
+    int32_t scalarQuantize(const float sample, const double scale) {
+        return static_cast<int32_t>(std::lrint(std::clamp(static_cast<double>(sample), -1.0, 1.0) * scale));
+    }
+}
+
+int main() {
+    std::mt19937 engine(42);
+    std::uniform_real_distribution distribution(-1.f, 1.f);
+
+    std::vector<float> samples(kSamples);
+    std::ranges::generate(samples, [&] { return distribution(engine); });
+
+    std::vector<float> floats(kSamples);
+    std::vector<int16_t> int16(kSamples);
+    std::vector<int32_t> int32(kSamples);
+    std::vector<unsigned char> int24(3 * kSamples);
+    std::vector<int16_t> grown;
+
+    std::cout << std::setw(22) << std::left << "conversion" << std::right
+              << std::setw(12) << "before" << std::setw(12) << "after" << "   (GB/s of float samples)\n";
+
+    report("float -> int16",
+           measureGbps([&] {
+               grown.clear();
+               std::ranges::transform(samples, std::back_inserter(grown), [](const float sample) {
+                   return static_cast<int16_t>(sample * 32767.f);
+               });
+           }),
+           measureGbps([&] { float_to_int16(samples, int16.data()); }));
+
+    report("int16 -> float",
+           measureGbps([&] {
+               std::ranges::transform(int16, floats.begin(), [](const int16_t sample) {
+                   return static_cast<float>(sample) / 32767.f;
+               });
+           }),
+           measureGbps([&] { int16_to_float(int16.data(), floats); }));
+
+    report("float -> int16 (sat)",
+           measureGbps([&] {
+               for (size_t i = 0; i < kSamples; ++i)
+                   int16[i] = static_cast<int16_t>(scalarQuantize(samples[i], 32767.0));
+           }),
+           measureGbps([&] { float_to_int16(samples, int16.data()); }));
+
+    report("float -> int24 (sat)",
+           measureGbps([&] {
+               for (size_t i = 0; i < kSamples; ++i) {
+                   const auto value = static_cast<uint32_t>(scalarQuantize(samples[i], 8388607.0));
+                   int24[3 * i] = static_cast<unsigned char>(value);
+                   int24[3 * i + 1] = static_cast<unsigned char>(value >> 8);
+                   int24[3 * i + 2] = static_cast<unsigned char>(value >> 16);
+               }
+           }),
+           measureGbps([&] { float_to_int24(samples, int24.data()); }));
+
+    report("int24 -> float",
+           measureGbps([&] {
+               for (size_t i = 0; i < kSamples; ++i) {
+                   const unsigned char *p = int24.data() + 3 * i;
+                   const auto value = static_cast<int32_t>(static_cast<uint32_t>(p[0]) << 8
+                                                         | static_cast<uint32_t>(p[1]) << 16
+                                                         | static_cast<uint32_t>(p[2]) << 24) >> 8;
+                   floats[i] = static_cast<float>(value / 8388607.0);
+               }
+           }),
+           measureGbps([&] { int24_to_float(int24.data(), floats); }));
+
+    report("float -> int32 (sat)",
+           measureGbps([&] {
+               for (size_t i = 0; i < kSamples; ++i)
+                   int32[i] = scalarQuantize(samples[i], 2147483647.0);
+           }),
+           measureGbps([&] { float_to_int32(samples, int32.data()); }));
+
+    report("int32 -> float",
+           measureGbps([&] {
+               for (size_t i = 0; i < kSamples; ++i)
+                   floats[i] = static_cast<float>(int32[i] / 2147483647.0);
+           }),
+           measureGbps([&] { int32_to_float(int32.data(), floats); }));
+
+    // Dither cost, relative to converting without it.
+    Ditherer tpdf(2, 16, DitherType::TPDF);
+    Ditherer shaped(2, 16, DitherType::SHAPED);
+    const double plain = measureGbps([&] { float_to_int16(samples, int16.data()); });
+    report("TPDF dither + int16", plain, measureGbps([&] {
+        std::ranges::copy(samples, floats.begin());
+        tpdf.process(floats);
+        float_to_int16(floats, int16.data());
+    }));
+    report("shaped dither + int16", plain, measureGbps([&] {
+        std::ranges::copy(samples, floats.begin());
+        shaped.process(floats);
+        float_to_int16(floats, int16.data());
+    }));
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include <fft_plan.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr int kMinBits{ 10 };
+    constexpr int kMaxBits{ 24 };
+    constexpr auto kMinDuration{ std::chrono::milliseconds(200) };
+
+    using Clock = std::chrono::steady_clock;
+
+    double measureGflops(fourier::FftPlan& plan, std::vector<fourier::complex>& data) {
+        plan.execute(data);
+
+        size_t iterations = 0;
+        const auto start = Clock::now();
+        auto elapsed = Clock::duration{};
+        do {
+            plan.execute(data);
+            ++iterations;
+            elapsed = Clock::now() - start;
+        } while (elapsed < kMinDuration);
+
+        const auto N = static_cast<double>(plan.size());
+        const double flops = 5.0 * N * std::log2(N) * static_cast<double>(iterations);
+        return flops / std::chrono::duration<double>(elapsed).count() / 1e9;
+    }
+}
+
+int main() {
+    std::mt19937 engine(42);
+    std::uniform_real_distribution distribution(-1.f, 1.f);
+
+    std::cout << std::setw(6) << "log2N"
+              << std::setw(14) << "radix-4"
+              << std::setw(14) << "four-step" << "   (GFLOPS, 5 N log2 N)\n";
+
+    for (int bits = kMinBits; bits <= kMaxBits; ++bits) {
+        const size_t N = size_t{1} << bits;
+        std::vector<fourier::complex> data(N);
+        std::ranges::generate(data, [&] {
+            return fourier::complex(distribution(engine), distribution(engine));
+        });
+
+        fourier::set_four_step_threshold(N);
+        fourier::FftPlan direct(N);
+        const double directGflops = measureGflops(direct, data);
+
+        fourier::set_four_step_threshold(0);
+        fourier::FftPlan fourStep(N);
+        const double fourStepGflops = measureGflops(fourStep, data);
+
+        std::cout << std::setw(6) << bits
+                  << std::setw(14) << std::fixed << std::setprecision(2) << directGflops
+                  << std::setw(14) << fourStepGflops << '\n';
+    }
+
+    return 0;
+}
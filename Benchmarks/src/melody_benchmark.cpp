@@ -0,0 +1,84 @@
+#include <melody_renderer.h>
+#include <thread_pool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    using SoundGenerator::MelodyRenderer;
+    using SoundGenerator::WaveType;
+
+    constexpr unsigned int kSampleRate{ 48000 };
+    constexpr unsigned int kChannels{ 2 };
+    constexpr float kBpm{ 160.f };
+    constexpr int kRepeats{ 40 };
+
+    using Clock = std::chrono::steady_clock;
+
+    // createComplexMelody() repeated every 7.5 bars with a little jitter, so
+    // the copies overlap: about three thousand notes.
+    std::vector<Melody::NoteData> createScore() {
+        std::mt19937 engine(42);
+        std::uniform_real_distribution jitter(0.f, 0.25f);
+
+        const auto melody = Melody::createComplexMelody();
+        std::vector<Melody::NoteData> score;
+        score.reserve(melody.size() * kRepeats);
+        for (int repeat = 0; repeat < kRepeats; ++repeat) {
+            for (auto note : melody) {
+                note.startBar += static_cast<float>(repeat) * 7.5f + jitter(engine);
+                score.push_back(note);
+            }
+        }
+        return score;
+    }
+
+    double measureSeconds(const MelodyRenderer& renderer, const std::vector<Melody::NoteData>& score,
+                          std::vector<float>& out, utils::ThreadPool& pool) {
+        renderer.render(score, out, pool);
+
+        const auto start = Clock::now();
+        renderer.render(score, out, pool);
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+}
+
+int main() {
+    const auto score = createScore();
+
+    MelodyRenderer renderer(kSampleRate, kChannels);
+    renderer.setWaveType(WaveType::SAWTOOTH);
+    renderer.setAmplitude(0.1f);
+    renderer.setTempo(kBpm);
+
+    std::vector<float> serial(renderer.frames(score) * kChannels);
+    std::vector<float> out(serial.size());
+
+    utils::ThreadPool serialPool(1);
+    const double serialSeconds = measureSeconds(renderer, score, serial, serialPool);
+
+    std::cout << score.size() << " notes, " << serial.size() / kChannels << " frames, tiles of "
+              << renderer.tileFrames() << " frames\n";
+    std::cout << std::setw(8) << "threads" << std::setw(12) << "ms"
+              << std::setw(12) << "speedup" << std::setw(12) << "identical\n";
+
+    const size_t maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        utils::ThreadPool pool(threads);
+        const double seconds = measureSeconds(renderer, score, out, pool);
+        const bool identical = std::memcmp(out.data(), serial.data(), out.size() * sizeof(float)) == 0;
+
+        std::cout << std::setw(8) << threads
+                  << std::setw(12) << std::fixed << std::setprecision(1) << seconds * 1e3
+                  << std::setw(12) << std::setprecision(2) << serialSeconds / seconds
+                  << std::setw(11) << (identical ? "yes" : "NO") << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include <oscillator.h>
+#include <sound_generator.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numbers>
+#include <string>
+#include <vector>
+
+namespace {
+    using SoundGenerator::Generator;
+    using SoundGenerator::ModulationType;
+    using SoundGenerator::Oscillator;
+    using SoundGenerator::WaveType;
+
+    constexpr unsigned int kSampleRate{ 48000 };
+    constexpr unsigned int kChannels{ 2 };
+    constexpr size_t kFrames{ 1 << 16 };
+    constexpr float kAmplitude{ 0.5f };
+    constexpr float kFrequency{ 440.f };
+    constexpr auto kMinDuration{ std::chrono::milliseconds(200) };
+
+    using Clock = std::chrono::steady_clock;
+
+    // Interleaved output samples per second, in millions.
+    template<typename Fn>
+    double measureMsps(Fn&& render) {
+        render();
+
+        size_t iterations = 0;
+        const auto start = Clock::now();
+        auto elapsed = Clock::duration{};
+        do {
+            render();
+            ++iterations;
+            elapsed = Clock::now() - start;
+        } while (elapsed < kMinDuration);
+
+        const double samples = static_cast<double>(kFrames * kChannels * iterations);
+        return samples / std::chrono::duration<double>(elapsed).count() / 1e6;
+    }
+
+    void report(const std::string& name, const double baseline, const double current) {
+        std::cout << std::setw(22) << std::left << name << std::right
+                  << std::setw(12) << std::fixed << std::setprecision(1) << baseline
+                  << std::setw(12) << current
+                  << std::setw(10) << std::setprecision(2) << current / baseline << "x\n";
+    }
+
+    // The per-sample loops getSound and getModulationSound ran before the
+    // oscillator: float time, a switch and a libm call for every sample of
+    // every channel.
+    void perSampleSound(std::vector<float>& out, const WaveType waveType) {
+        std::ranges::generate(out, [&, i = 0, sampleIndex = 0]() mutable -> float {
+            if (i++ % kChannels == 0)
+                sampleIndex++;
+            const float time{ static_cast<float>(sampleIndex) / static_cast<float>(kSampleRate) };
+            return kAmplitude * Generator::getSoundValue(waveType, kFrequency, time);
+        });
+    }
+
+    void perSampleModulation(std::vector<float>& out, const ModulationType modulationType) {
+        std::ranges::generate(out, [&, i = 0, sampleIndex = 0]() mutable -> float {
+            if (i++ % kChannels == 0)
+                sampleIndex++;
+            const float time{ static_cast<float>(sampleIndex) / static_cast<float>(kSampleRate) };
+            if (modulationType == ModulationType::AMPLITUDE)
+                return kAmplitude * Generator::getSinValue(1.f, time) * Generator::getSinValue(kFrequency, time);
+
+            const auto offset = static_cast<float>(30.f * std::cos(2.f * std::numbers::pi_v<float> * time));
+            return kAmplitude * static_cast<float>(std::sin(2.f * std::numbers::pi_v<float> * time * kFrequency + offset));
+        });
+    }
+}
+
+int main() {
+    std::vector<float> out(kFrames * kChannels);
+    std::vector<float> mono(kFrames);
+
+    std::cout << std::setw(22) << std::left << "waveform" << std::right
+              << std::setw(12) << "before" << std::setw(12) << "after" << "   (Msamples/s, stereo)\n";
+
+    const std::pair<const char *, WaveType> waves[] = {
+        {"sine", WaveType::SINUSOID},
+        {"sawtooth", WaveType::SAWTOOTH},
+        {"square", WaveType::IMPULSE},
+        {"triangle", WaveType::TRIANGLE},
+        {"noise", WaveType::NOISE},
+    };
+
+    for (const auto& [name, waveType] : waves) {
+        Oscillator oscillator(kSampleRate, kChannels);
+        oscillator.setWaveType(waveType);
+        oscillator.setFrequency(kFrequency);
+        oscillator.setAmplitude(kAmplitude);
+
+        report(name,
+               measureMsps([&] { perSampleSound(out, waveType); }),
+               measureMsps([&] { oscillator.render(out); }));
+    }
+
+    {
+        Oscillator carrier(kSampleRate, kChannels);
+        Oscillator modulator(kSampleRate, 1);
+        carrier.setFrequency(kFrequency);
+        carrier.setAmplitude(kAmplitude);
+        modulator.setFrequency(1.f);
+
+        report("amplitude modulation",
+               measureMsps([&] { perSampleModulation(out, ModulationType::AMPLITUDE); }),
+               measureMsps([&] {
+                   modulator.render(mono);
+                   carrier.render(out);
+                   for (size_t i = 0; i < kFrames; ++i)
+                       for (size_t channel = 0; channel < kChannels; ++channel)
+                           out[i * kChannels + channel] *= mono[i];
+               }));
+    }
+
+    {
+        Oscillator carrier(kSampleRate, kChannels);
+        Oscillator modulator(kSampleRate, 1);
+        carrier.setFrequency(kFrequency);
+        carrier.setAmplitude(kAmplitude);
+        modulator.setFrequency(1.f);
+        modulator.setAmplitude(static_cast<float>(30.0 / (2.0 * std::numbers::pi)));
+        modulator.setPhase(0.25);
+
+        report("frequency modulation",
+               measureMsps([&] { perSampleModulation(out, ModulationType::FREQUENCY); }),
+               measureMsps([&] {
+                   modulator.render(mono);
+                   carrier.render(out, mono);
+               }));
+    }
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+#ifndef MELODY_RENDERER_H
+#define MELODY_RENDERER_H
+
+#include "notes.h"
+#include "melody.h"
+#include "sound_generator.h"
+#include "synth.h"
+#include "thread_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace SoundGenerator {
+
+    // Offline renderer for a whole Melody::NoteData score. The timeline is
+    // cut into tiles of tileFrames that the pool renders independently, each
+    // into its own region of the output. Every note is voiced by its own
+    // Oscillator and Adsr, which a tile seeks to where the note crosses into
+    // it, and tiles add notes in score order; so every sample is the same
+    // whichever tiles and threads produce it, and a pool of size 1 gives the
+    // serial render.
+    class MelodyRenderer {
+    public:
+        explicit MelodyRenderer(unsigned int sampleRate = 48000, unsigned int channels = 2) noexcept;
+
+        void setWaveType(WaveType waveType) noexcept { m_waveType = waveType; }
+        void setEnvelope(const Envelope& envelope) noexcept { m_envelope = envelope; }
+        void setAmplitude(float amplitude) noexcept { m_amplitude = amplitude; }
+        void setTempo(float bpm) noexcept { m_bpm = bpm; }
+        void setTileFrames(size_t frames) noexcept;
+
+        // Frames the score lasts, releases included.
+        [[nodiscard]] size_t frames(std::span<const Melody::NoteData> score) const;
+
+        // out holds at least frames(score) interleaved frames; anything past
+        // them is left untouched.
+        void render(std::span<const Melody::NoteData> score, std::span<float> out,
+                    utils::ThreadPool& pool = utils::ThreadPool::global()) const;
+        [[nodiscard]] std::vector<float> render(std::span<const Melody::NoteData> score,
+                                                utils::ThreadPool& pool = utils::ThreadPool::global()) const;
+
+        [[nodiscard]] size_t tileFrames() const noexcept { return m_tileFrames; }
+
+    private:
+        struct Note {
+            uint64_t start{ 0 };
+            uint64_t length{ 0 };
+            uint64_t end{ 0 };
+            float frequency{ 0.f };
+            uint64_t seed{ 0 };
+        };
+
+        [[nodiscard]] std::vector<Note> layout(std::span<const Melody::NoteData> score) const;
+        void renderNote(const Note& note, uint64_t begin, uint64_t end, float *mix) const noexcept;
+
+        unsigned int m_sampleRate{ 48000 };
+        unsigned int m_channels{ 2 };
+
+        WaveType m_waveType{ WaveType::SINUSOID };
+        Envelope m_envelope;
+        float m_amplitude{ 1.f };
+        float m_bpm{ 120.f };
+        size_t m_tileFrames{ 16384 };
+    };
+
+} // namespace SoundGenerator
+
+#endif //MELODY_RENDERER_H
@@ -0,0 +1,54 @@
+#ifndef NOISE_H
+#define NOISE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace SoundGenerator {
+
+    enum class NoiseColor {
+        WHITE,
+        PINK,
+        BROWN,
+    };
+
+    // Per-instance noise source. Four interleaved xoshiro128+ streams, seeded
+    // through splitmix64, produce four uniform samples in [-1, 1) per step,
+    // so block fills run one SIMD register at a time. The sequence depends
+    // only on the seed, on every platform and with or without SIMD. Pink is
+    // white noise through Paul Kellet's -3 dB/octave filter, brown a leaky
+    // integrator; both are scaled to roughly the white noise range.
+    class Noise {
+    public:
+        explicit Noise(uint64_t seed = 0, NoiseColor color = NoiseColor::WHITE) noexcept;
+
+        // Restarts the sequence and clears the colour filters.
+        void seed(uint64_t seed) noexcept;
+        void setColor(NoiseColor color) noexcept { m_color = color; }
+
+        float next() noexcept;
+        void fill(std::span<float> out) noexcept;
+
+        [[nodiscard]] NoiseColor color() const noexcept { return m_color; }
+
+    private:
+        static constexpr size_t kLanes = 4;
+
+        void step(float *out) noexcept;
+        void white(float *out, size_t count) noexcept;
+        void shape(float *samples, size_t count) noexcept;
+
+        // m_state[word][lane]
+        alignas(16) uint32_t m_state[4][kLanes]{};
+        float m_pending[kLanes]{};
+        size_t m_pendingCount{ 0 };
+
+        NoiseColor m_color{ NoiseColor::WHITE };
+        float m_pink[7]{};
+        float m_brown{ 0.f };
+    };
+
+} // namespace SoundGenerator
+
+#endif //NOISE_H
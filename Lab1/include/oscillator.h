@@ -0,0 +1,72 @@
+#ifndef OSCILLATOR_H
+#define OSCILLATOR_H
+
+#include "noise.h"
+#include "sound_generator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace SoundGenerator {
+
+    // Phase-accumulator oscillator. The phase is kept in cycles as a double
+    // and advanced by frequency / sampleRate per frame, so it stays exact
+    // however long the oscillator runs. Sawtooth and square (IMPULSE) are
+    // band-limited with polyBLEP, the triangle with polyBLAMP. Each frame is
+    // computed once and copied to every channel; render() does so in blocks
+    // of kBlockFrames with one vectorised kernel per waveform.
+    class Oscillator {
+    public:
+        static constexpr size_t kBlockFrames = 256;
+
+        explicit Oscillator(unsigned int sampleRate = 48000, unsigned int channels = 2) noexcept;
+
+        void setWaveType(WaveType waveType) noexcept { m_waveType = waveType; }
+        void setFrequency(float frequency) noexcept;
+        void setAmplitude(float amplitude) noexcept { m_amplitude = amplitude; }
+        // Position within the cycle, wrapped into [0, 1).
+        void setPhase(double cycles) noexcept;
+        // NOISE only: the colour, and the seed that fixes the sequence.
+        void setNoiseColor(NoiseColor color) noexcept { m_noise.setColor(color); }
+        void setSeed(uint64_t seed) noexcept { m_noise.seed(seed); }
+
+        // Fills whole interleaved frames; never allocates.
+        void render(std::span<float> out) noexcept;
+        // Phase modulation: one offset in cycles per frame of out.
+        void render(std::span<float> out, std::span<const float> phaseOffsets) noexcept;
+        // Value of the current frame, then advances by one. phaseOffset, in
+        // cycles, shifts this frame only and so gives phase modulation.
+        float next(double phaseOffset = 0.0) noexcept;
+        // Advances exactly as render() of as many frames, without output, so
+        // a render can resume mid-sound with the same samples.
+        void skip(size_t frames) noexcept;
+
+        [[nodiscard]] WaveType waveType() const noexcept { return m_waveType; }
+        [[nodiscard]] float frequency() const noexcept { return m_frequency; }
+        [[nodiscard]] float amplitude() const noexcept { return m_amplitude; }
+        [[nodiscard]] double phase() const noexcept { return m_phase; }
+        [[nodiscard]] unsigned int sampleRate() const noexcept { return m_sampleRate; }
+        [[nodiscard]] unsigned int channels() const noexcept { return m_channels; }
+
+    private:
+        void advance() noexcept;
+        void renderBlocks(std::span<float> out, std::span<const float> phaseOffsets) noexcept;
+        float value(float phase) noexcept;
+
+        unsigned int m_sampleRate{ 48000 };
+        unsigned int m_channels{ 2 };
+
+        WaveType m_waveType{ WaveType::SINUSOID };
+        float m_frequency{ 0.f };
+        float m_amplitude{ 1.f };
+
+        double m_phase{ 0.0 };
+        double m_increment{ 0.0 };
+
+        Noise m_noise;
+    };
+
+} // namespace SoundGenerator
+
+#endif //OSCILLATOR_H
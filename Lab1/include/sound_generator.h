@@ -1,6 +1,8 @@
 #ifndef SOUNDGENERATOR_H
 #define SOUNDGENERATOR_H
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 namespace SoundGenerator {
@@ -20,7 +22,7 @@ namespace SoundGenerator {
 
     class Generator {
     public:
-        explicit Generator(unsigned int sampleRate = 44100, unsigned int channels = 2) noexcept;
+        explicit Generator(unsigned int sampleRate = 48000, unsigned int channels = 2) noexcept;
         virtual ~Generator() = default;
 
         static float getSinValue(float frequency, float phase = 0.f);
@@ -33,10 +35,14 @@ namespace SoundGenerator {
         void setBufferSize(size_t samples) noexcept { m_bufferSamples = samples; }
         void setSampleRate(unsigned int sampleRate) noexcept { m_sampleRate = sampleRate; }
         void setChannels(unsigned int channels) noexcept { m_channels = channels; }
+        // NOISE sounds are seeded from this and their sampleIndex, so a render
+        // repeats exactly whichever thread runs it.
+        void setSeed(uint64_t seed) noexcept { m_seed = seed; }
 
         [[nodiscard]] size_t getBufferSize() const noexcept { return m_bufferSamples; }
         [[nodiscard]] unsigned int getSampleRate() const noexcept { return m_sampleRate; }
         [[nodiscard]] unsigned int getChannels() const noexcept { return m_channels; }
+        [[nodiscard]] uint64_t getSeed() const noexcept { return m_seed; }
 
         [[nodiscard]] std::vector<float> getSound(WaveType waveType,
                                                   float amplitude,
@@ -52,9 +58,10 @@ namespace SoundGenerator {
                                                             float phase = 0.f) const;
 
     private:
-        unsigned int m_sampleRate{ 44100 };
+        unsigned int m_sampleRate{ 48000 };
         unsigned int m_channels{ 2 };
         size_t m_bufferSamples{ 1024 };
+        uint64_t m_seed{ 0 };
     };
 
 } // namespace SoundGenerator
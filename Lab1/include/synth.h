@@ -0,0 +1,150 @@
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include "oscillator.h"
+#include "sound_generator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace SoundGenerator {
+
+    // Segment times in seconds, sustain as a level in [0, 1].
+    struct Envelope {
+        float attack{ 0.005f };
+        float decay{ 0.05f };
+        float sustain{ 0.8f };
+        float release{ 0.05f };
+    };
+
+    // Linear ADSR. process() multiplies a block in place, a whole segment
+    // at a time, so changes land on exact frames. Each level is computed from
+    // the position in its segment, so skip() followed by process() gives the
+    // same samples as processing from the start.
+    class Adsr {
+    public:
+        enum class Stage {
+            IDLE,
+            ATTACK,
+            DECAY,
+            SUSTAIN,
+            RELEASE,
+        };
+
+        explicit Adsr(unsigned int sampleRate = 48000) noexcept;
+
+        void setEnvelope(const Envelope& envelope) noexcept;
+        void noteOn() noexcept;
+        void noteOff() noexcept;
+        void reset() noexcept;
+
+        void process(std::span<float> samples) noexcept;
+        // Advances as process() would, without touching any samples.
+        void skip(size_t frames) noexcept;
+
+        [[nodiscard]] Stage stage() const noexcept { return m_stage; }
+        [[nodiscard]] float level() const noexcept { return m_level; }
+        [[nodiscard]] bool active() const noexcept { return m_stage != Stage::IDLE; }
+
+    private:
+        void enter(Stage stage) noexcept;
+        void advance(float *samples, size_t count) noexcept;
+
+        unsigned int m_sampleRate{ 48000 };
+        Envelope m_envelope;
+
+        Stage m_stage{ Stage::IDLE };
+        float m_level{ 0.f };
+        float m_from{ 0.f };
+        float m_target{ 0.f };
+        float m_step{ 0.f };
+        size_t m_length{ 0 };
+        size_t m_elapsed{ 0 };
+    };
+
+    struct NoteEvent {
+        enum class Type {
+            ON,
+            OFF,
+        };
+
+        // Frames from the start of the stream.
+        uint64_t frame{ 0 };
+        Type type{ Type::ON };
+        // Matches an OFF to the ON it ends.
+        int note{ 0 };
+        float frequency{ 0.f };
+        float velocity{ 1.f };
+    };
+
+    // Polyphonic synthesizer with a fixed voice pool: one Oscillator and one
+    // Adsr per voice, all allocated up front. Events are kept sorted by frame
+    // and applied at that exact frame while render() streams consecutive
+    // blocks straight into the caller's buffer; when every voice is busy,
+    // a NOTE ON takes the quietest releasing voice, else the oldest.
+    class Synth {
+    public:
+        explicit Synth(unsigned int sampleRate = 48000, unsigned int channels = 2,
+                       size_t voices = 32, size_t eventCapacity = 1024);
+
+        void setWaveType(WaveType waveType) noexcept { m_waveType = waveType; }
+        void setEnvelope(const Envelope& envelope) noexcept { m_envelope = envelope; }
+        void setAmplitude(float amplitude) noexcept { m_amplitude = amplitude; }
+
+        // Events may arrive in any order; ones already due are applied at the
+        // start of the next render(). At one frame an OFF goes before an ON,
+        // otherwise events keep the order they were scheduled in. Allocates
+        // only past eventCapacity pending events.
+        void schedule(const NoteEvent& event);
+        void schedule(std::span<const NoteEvent> events);
+        // Silences every voice and drops pending events.
+        void reset() noexcept;
+
+        // Fills whole interleaved frames and advances the stream by as many.
+        void render(std::span<float> out) noexcept;
+
+        [[nodiscard]] uint64_t frame() const noexcept { return m_frame; }
+        [[nodiscard]] size_t activeVoices() const noexcept;
+        // Nothing sounding and nothing left to play.
+        [[nodiscard]] bool idle() const noexcept;
+
+    private:
+        struct Pending {
+            NoteEvent event;
+            uint64_t sequence{ 0 };
+        };
+
+        struct Voice {
+            Oscillator oscillator;
+            Adsr envelope;
+            int note{ 0 };
+            float gain{ 0.f };
+            uint64_t started{ 0 };
+        };
+
+        void apply(const NoteEvent& event) noexcept;
+        Voice& allocate() noexcept;
+        void renderSegment(float *out, size_t frames) noexcept;
+
+        unsigned int m_sampleRate{ 48000 };
+        unsigned int m_channels{ 2 };
+
+        WaveType m_waveType{ WaveType::SINUSOID };
+        Envelope m_envelope;
+        float m_amplitude{ 1.f };
+
+        std::vector<Voice> m_voices;
+        std::vector<Pending> m_events;
+        size_t m_nextEvent{ 0 };
+        uint64_t m_sequence{ 0 };
+        uint64_t m_frame{ 0 };
+
+        float m_voiceBuffer[Oscillator::kBlockFrames]{};
+        float m_mix[Oscillator::kBlockFrames]{};
+    };
+
+} // namespace SoundGenerator
+
+#endif //SYNTH_H
@@ -1,10 +1,12 @@
 #include "wav_file.h"
 #include "sound_generator.h"
+#include "synth.h"
 #include "notes.h"
 #include "track.h"
 #include "melody.h"
 
 #include <chrono>
+#include <cmath>
 #include <vector>
 #include <algorithm>
 #include <iostream>
@@ -16,6 +18,8 @@ namespace {
     using WaveType = SoundGenerator::WaveType;
     using Generator = SoundGenerator::Generator;
     using ModulationType = SoundGenerator::ModulationType;
+    using NoteEvent = SoundGenerator::NoteEvent;
+    using Synth = SoundGenerator::Synth;
 
     constexpr unsigned int kChannels{2};
     constexpr unsigned int kSampleRate{48000};
@@ -42,6 +46,30 @@ namespace {
         const auto milliseconds = duration.count();
         return static_cast<size_t>(static_cast<float>(milliseconds) * kSampleRate / 1000);
     }
+
+    // Most notes sounding at once, counting each release tail.
+    size_t peakPolyphony(std::vector<NoteEvent> events, uint64_t releaseFrames) {
+        for (auto& event : events) {
+            if (event.type == NoteEvent::Type::OFF)
+                event.frame += releaseFrames;
+        }
+        std::ranges::sort(events, [](const NoteEvent& lhs, const NoteEvent& rhs) {
+            if (lhs.frame != rhs.frame)
+                return lhs.frame < rhs.frame;
+            return lhs.type == NoteEvent::Type::OFF && rhs.type == NoteEvent::Type::ON;
+        });
+
+        size_t sounding = 0;
+        size_t peak = 0;
+        for (const auto& event : events) {
+            if (event.type == NoteEvent::Type::ON) {
+                peak = std::max(peak, ++sounding);
+            } else {
+                --sounding;
+            }
+        }
+        return peak;
+    }
 }
 
 void task1() {
@@ -117,30 +145,46 @@ void task3() {
 void task4() {
     constexpr auto kFileName{ "TASK_4.wav" };
     constexpr auto kBpm{ 160.f };
-
-    Generator generator(kSampleRate, kChannels);
+    constexpr size_t kBlockFrames{ 1024 };
+    constexpr size_t kVoices{ 16 };
 
     const auto& melody = Melody::createComplexMelody();
 
-    Track track(kChannels);
-    std::ranges::for_each(melody, [&](const auto& note) {
-        const auto& [frequency, startBar, length] = note;
+    std::vector<NoteEvent> events;
+    events.reserve(melody.size() * 2);
+    for (int note = 0; const auto& [frequency, startBar, length] : melody) {
         const auto noteDurationMs = std::chrono::milliseconds(
             static_cast<int>(length * 4 * 60000.f / kBpm)
         );
         const auto noteStartTimeMs = std::chrono::milliseconds(
             static_cast<int>(startBar * 4 * 60000.f / kBpm)
         );
-        const auto samplesCount = getSamplesCount(noteDurationMs);
         const auto startSampleIndex = getSamplesCount(noteStartTimeMs);
+        const auto samplesCount = getSamplesCount(noteDurationMs);
 
-        generator.setBufferSize(samplesCount);
-        track.insert(generator.getSound(WaveType::IMPULSE, 0.2f, frequency), startSampleIndex);
-    });
-    track.normalize();
+        events.push_back({.frame = startSampleIndex, .type = NoteEvent::Type::ON, .note = note, .frequency = frequency});
+        events.push_back({.frame = startSampleIndex + samplesCount, .type = NoteEvent::Type::OFF, .note = note});
+        ++note;
+    }
+
+    // A voice never exceeds its gain and no more than the peak polyphony
+    // sound at once, so this keeps the mix within [-1, 1].
+    const SoundGenerator::Envelope envelope;
+    const auto releaseFrames = static_cast<uint64_t>(std::lround(envelope.release * kSampleRate));
+    const auto polyphony = std::clamp<size_t>(peakPolyphony(events, releaseFrames), 1, kVoices);
+
+    Synth synth(kSampleRate, kChannels, kVoices, events.size());
+    synth.setWaveType(WaveType::IMPULSE);
+    synth.setEnvelope(envelope);
+    synth.setAmplitude(1.f / static_cast<float>(polyphony));
+    synth.schedule(events);
 
     WavFile file(kSampleRate, kChannels);
-    file.append(track.getData());
+    std::vector<float> block(kBlockFrames * kChannels);
+    while (!synth.idle()) {
+        synth.render(block);
+        file.append(block);
+    }
 
     if (!file.save(kFileName)) {
         std::cerr << "Failed to save file " << kFileName << std::endl;
@@ -0,0 +1,166 @@
+#include "melody_renderer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    using SoundGenerator::Adsr;
+
+    // Same rounding as task4: whole milliseconds first, then frames.
+    uint64_t bars_to_frames(float bars, float bpm, unsigned int sampleRate) {
+        const int milliseconds = static_cast<int>(bars * 4 * 60000.f / bpm);
+        return static_cast<uint64_t>(static_cast<float>(std::max(milliseconds, 0)) * sampleRate / 1000);
+    }
+
+    // Runs the envelope over note-local frames [from, from + count), with the
+    // note released at frame length.
+    void envelope_run(Adsr& envelope, float *samples, uint64_t from, size_t count, uint64_t length) noexcept {
+        if (from <= length && length < from + count) {
+            const auto held = static_cast<size_t>(length - from);
+            if (samples != nullptr) {
+                envelope.process({samples, held});
+            } else {
+                envelope.skip(held);
+            }
+            envelope.noteOff();
+            from += held;
+            count -= held;
+            if (samples != nullptr)
+                samples += held;
+        }
+
+        if (samples != nullptr) {
+            envelope.process({samples, count});
+        } else {
+            envelope.skip(count);
+        }
+    }
+}
+
+namespace SoundGenerator {
+
+    MelodyRenderer::MelodyRenderer(unsigned int sampleRate, unsigned int channels) noexcept
+    : m_sampleRate(std::max(sampleRate, 1u))
+    , m_channels(std::max(channels, 1u))
+    {}
+
+    void MelodyRenderer::setTileFrames(size_t frames) noexcept {
+        m_tileFrames = std::max(frames, Oscillator::kBlockFrames);
+    }
+
+    size_t MelodyRenderer::frames(std::span<const Melody::NoteData> score) const {
+        uint64_t total = 0;
+        for (const auto& note : layout(score))
+            total = std::max(total, note.end);
+        return static_cast<size_t>(total);
+    }
+
+    std::vector<float> MelodyRenderer::render(std::span<const Melody::NoteData> score, utils::ThreadPool& pool) const {
+        std::vector<float> result(frames(score) * m_channels);
+        render(score, result, pool);
+        return result;
+    }
+
+    void MelodyRenderer::render(std::span<const Melody::NoteData> score, std::span<float> out, utils::ThreadPool& pool) const {
+        const auto notes = layout(score);
+
+        uint64_t total = 0;
+        for (const auto& note : notes)
+            total = std::max(total, note.end);
+        total = std::min<uint64_t>(total, out.size() / m_channels);
+
+        const size_t tiles = static_cast<size_t>((total + m_tileFrames - 1) / m_tileFrames);
+
+        // Notes overlapping each tile, in score order: tile t owns
+        // tileNotes[offsets[t], offsets[t + 1]).
+        std::vector<size_t> offsets(tiles + 1, 0);
+        for (const auto& note : notes) {
+            if (note.start >= total || note.end <= note.start)
+                continue;
+            const uint64_t last = std::min(note.end, total) - 1;
+            for (uint64_t tile = note.start / m_tileFrames; tile <= last / m_tileFrames; ++tile)
+                ++offsets[tile + 1];
+        }
+        for (size_t tile = 0; tile < tiles; ++tile)
+            offsets[tile + 1] += offsets[tile];
+
+        std::vector<size_t> tileNotes(offsets.back());
+        std::vector<size_t> filled(offsets.begin(), offsets.end() - 1);
+        for (size_t index = 0; index < notes.size(); ++index) {
+            const auto& note = notes[index];
+            if (note.start >= total || note.end <= note.start)
+                continue;
+            const uint64_t last = std::min(note.end, total) - 1;
+            for (uint64_t tile = note.start / m_tileFrames; tile <= last / m_tileFrames; ++tile)
+                tileNotes[filled[tile]++] = index;
+        }
+
+        pool.parallelFor(tiles, [&](const size_t tile) {
+            const uint64_t begin = tile * m_tileFrames;
+            const uint64_t end = std::min<uint64_t>(begin + m_tileFrames, total);
+            float *frame = out.data() + begin * m_channels;
+            const auto count = static_cast<size_t>(end - begin);
+
+            for (size_t i = 0; i < count; ++i)
+                frame[i * m_channels] = 0.f;
+
+            for (size_t i = offsets[tile]; i < offsets[tile + 1]; ++i)
+                renderNote(notes[tileNotes[i]], begin, end, frame);
+
+            for (size_t i = 0; i < count; ++i)
+                std::fill_n(frame + i * m_channels + 1, m_channels - 1, frame[i * m_channels]);
+        });
+    }
+
+    std::vector<MelodyRenderer::Note> MelodyRenderer::layout(std::span<const Melody::NoteData> score) const {
+        const auto release = static_cast<uint64_t>(
+            std::lround(std::max(m_envelope.release, 0.f) * static_cast<float>(m_sampleRate)));
+
+        std::vector<Note> notes;
+        notes.reserve(score.size());
+        for (const auto& [frequency, startBar, length] : score) {
+            Note note;
+            note.start = bars_to_frames(startBar, m_bpm, m_sampleRate);
+            note.length = bars_to_frames(length, m_bpm, m_sampleRate);
+            note.end = note.start + note.length + release;
+            note.frequency = frequency;
+            note.seed = notes.size();
+            notes.push_back(note);
+        }
+        return notes;
+    }
+
+    // Adds the note's frames in [begin, end) into channel 0 of out, which
+    // starts at frame begin. Rendering starts from the last block boundary,
+    // counted from the note's start, before the tile, so the oscillator runs
+    // the same blocks as it would from the note's first frame.
+    void MelodyRenderer::renderNote(const Note& note, const uint64_t begin, const uint64_t end, float *out) const noexcept {
+        constexpr size_t kBlockFrames{ Oscillator::kBlockFrames };
+
+        const uint64_t first = std::max(begin, note.start) - note.start;
+        const uint64_t last = std::min(end, note.end) - note.start;
+        const uint64_t seek = first / kBlockFrames * kBlockFrames;
+
+        Oscillator oscillator(m_sampleRate, 1);
+        oscillator.setWaveType(m_waveType);
+        oscillator.setFrequency(note.frequency);
+        oscillator.setSeed(note.seed);
+        oscillator.skip(static_cast<size_t>(seek));
+
+        Adsr envelope(m_sampleRate);
+        envelope.setEnvelope(m_envelope);
+        envelope.noteOn();
+        envelope_run(envelope, nullptr, 0, static_cast<size_t>(seek), note.length);
+
+        float block[kBlockFrames];
+        for (uint64_t position = seek; position < last; position += kBlockFrames) {
+            const auto count = static_cast<size_t>(std::min<uint64_t>(kBlockFrames, last - position));
+            oscillator.render({block, count});
+            envelope_run(envelope, block, position, count, note.length);
+
+            for (uint64_t i = std::max(position, first); i < position + count; ++i)
+                out[(note.start + i - begin) * m_channels] += m_amplitude * block[i - position];
+        }
+    }
+
+} // namespace SoundGenerator
@@ -0,0 +1,194 @@
+#include "noise.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define NOISE_HAVE_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define NOISE_HAVE_NEON
+#endif
+
+namespace {
+    // The top 24 bits of a xoshiro128+ output are its best ones, and as a
+    // float in [0, 2) minus one they land exactly on a 2^-23 grid in [-1, 1).
+    constexpr float kUnitScale{ 0x1p-23f };
+
+    // Paul Kellet's refined pink filter, accurate to 0.05 dB above 9.2 Hz.
+    constexpr float kPinkPoles[6]{ 0.99886f, 0.99332f, 0.96900f, 0.86650f, 0.55000f, -0.7616f };
+    constexpr float kPinkGains[6]{ 0.0555179f, 0.0750759f, 0.1538520f, 0.3104856f, 0.5329522f, -0.0168980f };
+    constexpr float kPinkDirect{ 0.5362f };
+    constexpr float kPinkDelayed{ 0.115926f };
+    constexpr float kPinkScale{ 0.11f };
+
+    constexpr float kBrownLeak{ 0.995f };
+    constexpr float kBrownGain{ 0.04f };
+
+    uint64_t splitmix64(uint64_t& state) noexcept {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+}
+
+namespace SoundGenerator {
+
+    Noise::Noise(uint64_t seed, NoiseColor color) noexcept
+    : m_color(color)
+    {
+        this->seed(seed);
+    }
+
+    void Noise::seed(uint64_t seed) noexcept {
+        for (size_t word = 0; word < 4; ++word) {
+            for (size_t lane = 0; lane < kLanes; lane += 2) {
+                const uint64_t bits = splitmix64(seed);
+                m_state[word][lane] = static_cast<uint32_t>(bits);
+                m_state[word][lane + 1] = static_cast<uint32_t>(bits >> 32);
+            }
+        }
+
+        m_pendingCount = 0;
+        std::fill(std::begin(m_pink), std::end(m_pink), 0.f);
+        m_brown = 0.f;
+    }
+
+    float Noise::next() noexcept {
+        if (m_pendingCount == 0) {
+            step(m_pending);
+            m_pendingCount = kLanes;
+        }
+
+        float sample = m_pending[kLanes - m_pendingCount--];
+        shape(&sample, 1);
+        return sample;
+    }
+
+    void Noise::fill(std::span<float> out) noexcept {
+        float *samples = out.data();
+        const size_t count = out.size();
+
+        const size_t buffered = std::min(count, m_pendingCount);
+        std::copy_n(m_pending + kLanes - m_pendingCount, buffered, samples);
+        m_pendingCount -= buffered;
+
+        const size_t steps = (count - buffered) / kLanes * kLanes;
+        white(samples + buffered, steps);
+
+        const size_t rest = count - buffered - steps;
+        if (rest > 0) {
+            step(m_pending);
+            std::copy_n(m_pending, rest, samples + buffered + steps);
+            m_pendingCount = kLanes - rest;
+        }
+
+        shape(samples, count);
+    }
+
+    void Noise::step(float *out) noexcept {
+        white(out, kLanes);
+    }
+
+    // count is a multiple of kLanes. Each iteration advances all four
+    // streams once and writes one sample from each, lane order.
+    void Noise::white(float *out, const size_t count) noexcept {
+#if defined(NOISE_HAVE_SSE2)
+        __m128i s0 = _mm_load_si128(reinterpret_cast<const __m128i *>(m_state[0]));
+        __m128i s1 = _mm_load_si128(reinterpret_cast<const __m128i *>(m_state[1]));
+        __m128i s2 = _mm_load_si128(reinterpret_cast<const __m128i *>(m_state[2]));
+        __m128i s3 = _mm_load_si128(reinterpret_cast<const __m128i *>(m_state[3]));
+        const __m128 scale = _mm_set1_ps(kUnitScale);
+        const __m128 one = _mm_set1_ps(1.f);
+
+        for (size_t i = 0; i < count; i += kLanes) {
+            const __m128i result = _mm_add_epi32(s0, s3);
+            const __m128i t = _mm_slli_epi32(s1, 9);
+            s2 = _mm_xor_si128(s2, s0);
+            s3 = _mm_xor_si128(s3, s1);
+            s1 = _mm_xor_si128(s1, s2);
+            s0 = _mm_xor_si128(s0, s3);
+            s2 = _mm_xor_si128(s2, t);
+            s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+
+            const __m128 value = _mm_cvtepi32_ps(_mm_srli_epi32(result, 8));
+            _mm_storeu_ps(out + i, _mm_sub_ps(_mm_mul_ps(value, scale), one));
+        }
+
+        _mm_store_si128(reinterpret_cast<__m128i *>(m_state[0]), s0);
+        _mm_store_si128(reinterpret_cast<__m128i *>(m_state[1]), s1);
+        _mm_store_si128(reinterpret_cast<__m128i *>(m_state[2]), s2);
+        _mm_store_si128(reinterpret_cast<__m128i *>(m_state[3]), s3);
+#elif defined(NOISE_HAVE_NEON)
+        uint32x4_t s0 = vld1q_u32(m_state[0]);
+        uint32x4_t s1 = vld1q_u32(m_state[1]);
+        uint32x4_t s2 = vld1q_u32(m_state[2]);
+        uint32x4_t s3 = vld1q_u32(m_state[3]);
+        const float32x4_t scale = vdupq_n_f32(kUnitScale);
+        const float32x4_t one = vdupq_n_f32(1.f);
+
+        for (size_t i = 0; i < count; i += kLanes) {
+            const uint32x4_t result = vaddq_u32(s0, s3);
+            const uint32x4_t t = vshlq_n_u32(s1, 9);
+            s2 = veorq_u32(s2, s0);
+            s3 = veorq_u32(s3, s1);
+            s1 = veorq_u32(s1, s2);
+            s0 = veorq_u32(s0, s3);
+            s2 = veorq_u32(s2, t);
+            s3 = vorrq_u32(vshlq_n_u32(s3, 11), vshrq_n_u32(s3, 21));
+
+            const float32x4_t value = vcvtq_f32_u32(vshrq_n_u32(result, 8));
+            vst1q_f32(out + i, vsubq_f32(vmulq_f32(value, scale), one));
+        }
+
+        vst1q_u32(m_state[0], s0);
+        vst1q_u32(m_state[1], s1);
+        vst1q_u32(m_state[2], s2);
+        vst1q_u32(m_state[3], s3);
+#else
+        auto& [s0, s1, s2, s3] = m_state;
+        for (size_t i = 0; i < count; i += kLanes) {
+            for (size_t lane = 0; lane < kLanes; ++lane) {
+                const uint32_t result = s0[lane] + s3[lane];
+                const uint32_t t = s1[lane] << 9;
+                s2[lane] ^= s0[lane];
+                s3[lane] ^= s1[lane];
+                s1[lane] ^= s2[lane];
+                s0[lane] ^= s3[lane];
+                s2[lane] ^= t;
+                s3[lane] = (s3[lane] << 11) | (s3[lane] >> 21);
+
+                out[i + lane] = static_cast<float>(result >> 8) * kUnitScale - 1.f;
+            }
+        }
+#endif
+    }
+
+    // The colour filters are recursive, so they run per sample over the
+    // block the generator has already filled.
+    void Noise::shape(float *samples, const size_t count) noexcept {
+        if (m_color == NoiseColor::PINK) {
+            float b[7];
+            std::copy(std::begin(m_pink), std::end(m_pink), b);
+            for (size_t i = 0; i < count; ++i) {
+                const float w = samples[i];
+                for (size_t pole = 0; pole < 6; ++pole)
+                    b[pole] = kPinkPoles[pole] * b[pole] + kPinkGains[pole] * w;
+                const float pink = b[0] + b[1] + b[2] + b[3] + b[4] + b[5] + b[6] + kPinkDirect * w;
+                b[6] = kPinkDelayed * w;
+                samples[i] = kPinkScale * pink;
+            }
+            std::copy(b, b + 7, m_pink);
+        }
+        else if (m_color == NoiseColor::BROWN) {
+            float b = m_brown;
+            for (size_t i = 0; i < count; ++i) {
+                b = kBrownLeak * b + kBrownGain * samples[i];
+                samples[i] = b;
+            }
+            m_brown = b;
+        }
+    }
+
+} // namespace SoundGenerator
@@ -1,4 +1,6 @@
 #include "sound_generator.h"
+#include "noise.h"
+#include "oscillator.h"
 
 #include <algorithm>
 #include <cmath>
@@ -9,6 +11,13 @@
 
 namespace {
     constexpr auto PI = std::numbers::pi;
+
+    // Cycles completed at the frame sampleIndex of a sound starting phase
+    // seconds in, kept in double so long offsets stay exact.
+    double start_cycles(float frequency, float phase, int sampleIndex, unsigned int sampleRate) {
+        const double time = static_cast<double>(phase) + static_cast<double>(sampleIndex) / sampleRate;
+        return static_cast<double>(frequency) * time;
+    }
 }
 
 namespace SoundGenerator {
@@ -40,11 +49,8 @@ namespace SoundGenerator {
     }
 
     float Generator::getRandValue() {
-        static std::random_device rd;
-        static std::default_random_engine generator(rd());
-        static std::uniform_real_distribution distribution(-1.f, 1.f);
-
-        return distribution(generator);
+        thread_local Noise noise(std::random_device{}());
+        return noise.next();
     }
 
     float Generator::getSoundValue(WaveType waveType, float frequency, float phase) {
@@ -67,47 +73,57 @@ namespace SoundGenerator {
     std::vector<float> Generator::getSound(WaveType waveType, float amplitude, float frequency, int sampleIndex, float phase) const {
         std::vector<float> result(m_bufferSamples * m_channels);
 
-        std::ranges::generate(result, [&, i=0]() mutable -> float {
-            if (i++ % m_channels == 0)
-                sampleIndex++;
-
-            float currentPhase{ phase + static_cast<float>(sampleIndex) / static_cast<float>(m_sampleRate) };
-            float soundValue = getSoundValue(waveType, frequency, currentPhase);
-
-            return amplitude * soundValue;
-        });
+        Oscillator oscillator(m_sampleRate, m_channels);
+        oscillator.setWaveType(waveType);
+        oscillator.setFrequency(frequency);
+        oscillator.setAmplitude(amplitude);
+        oscillator.setPhase(start_cycles(frequency, phase, sampleIndex, m_sampleRate));
+        oscillator.setSeed(m_seed + static_cast<uint64_t>(sampleIndex));
+        oscillator.render(result);
 
         return result;
     }
 
     std::vector<float> Generator::getModulationSound(ModulationType modulationType, WaveType waveType, float amplitude, float frequency, int sampleIndex, float phase) const {
         std::vector<float> result(m_bufferSamples * m_channels);
-        std::ranges::generate(result, [&, i=0]() mutable -> float {
-            if (i++ % m_channels == 0)
-                sampleIndex++;
 
-            const float currentPhase{ phase + static_cast<float>(sampleIndex) / static_cast<float>(m_sampleRate) };
+        Oscillator carrier(m_sampleRate, m_channels);
+        carrier.setFrequency(frequency);
+        carrier.setAmplitude(amplitude);
+        carrier.setPhase(start_cycles(frequency, phase, sampleIndex, m_sampleRate));
 
-            if (modulationType == ModulationType::AMPLITUDE) {
-                constexpr float amplitudeModulationFrequency{ 1.f };
+        Oscillator modulator(m_sampleRate, 1);
 
-                const float amplitudeMultiplier = getSinValue(amplitudeModulationFrequency, currentPhase);
-                const float currentAmplitude = amplitude * amplitudeMultiplier;
-                const float soundValue = getSoundValue(waveType, frequency, currentPhase);
+        if (modulationType == ModulationType::AMPLITUDE) {
+            constexpr float amplitudeModulationFrequency{ 1.f };
 
-                return currentAmplitude * soundValue;
-            }
-            if (modulationType == ModulationType::FREQUENCY) {
-                constexpr float modulationFrequency{ 1.f };
-                constexpr float frequencyModulationAmplitude{ 30.f };
+            carrier.setWaveType(waveType);
+            carrier.setSeed(m_seed + static_cast<uint64_t>(sampleIndex));
+            modulator.setFrequency(amplitudeModulationFrequency);
+            modulator.setPhase(start_cycles(amplitudeModulationFrequency, phase, sampleIndex, m_sampleRate));
 
-                const float integratedFrequency = static_cast<float>(frequencyModulationAmplitude * std::cos(2.f * PI * modulationFrequency * currentPhase));
-                const float soundValue = static_cast<float>(std::sin(2.f * PI * currentPhase * frequency + integratedFrequency));
+            std::vector<float> envelope(m_bufferSamples);
+            modulator.render(envelope);
+            carrier.render(result);
 
-                return amplitude * soundValue;
-            }
-            return 0.f;
-        });
+            float *frame = result.data();
+            for (size_t i = 0; i < m_bufferSamples; ++i, frame += m_channels)
+                for (unsigned int channel = 0; channel < m_channels; ++channel)
+                    frame[channel] *= envelope[i];
+        }
+        else if (modulationType == ModulationType::FREQUENCY) {
+            constexpr float modulationFrequency{ 1.f };
+            constexpr float frequencyModulationAmplitude{ 30.f };
+
+            // The sine's phase swings by frequencyModulationAmplitude radians.
+            modulator.setFrequency(modulationFrequency);
+            modulator.setAmplitude(static_cast<float>(frequencyModulationAmplitude / (2 * PI)));
+            modulator.setPhase(start_cycles(modulationFrequency, phase, sampleIndex, m_sampleRate) + 0.25);
+
+            std::vector<float> offsets(m_bufferSamples);
+            modulator.render(offsets);
+            carrier.render(result, offsets);
+        }
 
         return result;
     }
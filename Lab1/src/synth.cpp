@@ -0,0 +1,249 @@
+#include "synth.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    using SoundGenerator::NoteEvent;
+
+    // Frame order, with an OFF before an ON at the same frame so a repeated
+    // note is not cut by the end of the one before; then scheduling order.
+    template<typename Pending>
+    bool event_before(const Pending& lhs, const Pending& rhs) noexcept {
+        if (lhs.event.frame != rhs.event.frame)
+            return lhs.event.frame < rhs.event.frame;
+        if (lhs.event.type != rhs.event.type)
+            return lhs.event.type == NoteEvent::Type::OFF;
+        return lhs.sequence < rhs.sequence;
+    }
+}
+
+namespace SoundGenerator {
+
+    Adsr::Adsr(unsigned int sampleRate) noexcept
+    : m_sampleRate(std::max(sampleRate, 1u))
+    {}
+
+    void Adsr::setEnvelope(const Envelope& envelope) noexcept {
+        m_envelope = envelope;
+        m_envelope.sustain = std::clamp(envelope.sustain, 0.f, 1.f);
+    }
+
+    // Retriggering starts the attack from the current level, so a stolen
+    // voice does not jump to zero.
+    void Adsr::noteOn() noexcept {
+        enter(Stage::ATTACK);
+    }
+
+    void Adsr::noteOff() noexcept {
+        if (m_stage != Stage::IDLE && m_stage != Stage::RELEASE)
+            enter(Stage::RELEASE);
+    }
+
+    void Adsr::reset() noexcept {
+        m_level = 0.f;
+        enter(Stage::IDLE);
+    }
+
+    void Adsr::enter(Stage stage) noexcept {
+        float seconds{ 0.f };
+        switch (stage) {
+            case Stage::ATTACK:
+                seconds = m_envelope.attack;
+                m_target = 1.f;
+                break;
+            case Stage::DECAY:
+                seconds = m_envelope.decay;
+                m_target = m_envelope.sustain;
+                break;
+            case Stage::RELEASE:
+                seconds = m_envelope.release;
+                m_target = 0.f;
+                break;
+            case Stage::SUSTAIN:
+                m_level = m_envelope.sustain;
+                m_stage = m_level > 0.f ? Stage::SUSTAIN : Stage::IDLE;
+                return;
+            default:
+                m_level = 0.f;
+                m_stage = Stage::IDLE;
+                return;
+        }
+
+        m_stage = stage;
+        m_length = static_cast<size_t>(std::lround(std::max(seconds, 0.f) * static_cast<float>(m_sampleRate)));
+        if (m_length == 0) {
+            m_level = m_target;
+            enter(stage == Stage::ATTACK ? Stage::DECAY : stage == Stage::DECAY ? Stage::SUSTAIN : Stage::IDLE);
+            return;
+        }
+        m_from = m_level;
+        m_elapsed = 0;
+        m_step = (m_target - m_from) / static_cast<float>(m_length);
+    }
+
+    void Adsr::process(std::span<float> samples) noexcept {
+        advance(samples.data(), samples.size());
+    }
+
+    void Adsr::skip(const size_t frames) noexcept {
+        advance(nullptr, frames);
+    }
+
+    void Adsr::advance(float *samples, size_t count) noexcept {
+        while (count > 0) {
+            if (m_stage == Stage::IDLE) {
+                if (samples != nullptr)
+                    std::fill_n(samples, count, 0.f);
+                return;
+            }
+            if (m_stage == Stage::SUSTAIN) {
+                if (samples != nullptr) {
+                    for (size_t i = 0; i < count; ++i)
+                        samples[i] *= m_level;
+                }
+                return;
+            }
+
+            const size_t run = std::min(count, m_length - m_elapsed);
+            if (samples != nullptr) {
+                for (size_t i = 0; i < run; ++i)
+                    samples[i] *= m_from + m_step * static_cast<float>(m_elapsed + i + 1);
+                samples += run;
+            }
+            m_elapsed += run;
+            count -= run;
+
+            if (m_elapsed == m_length) {
+                m_level = m_target;
+                enter(m_stage == Stage::ATTACK ? Stage::DECAY : m_stage == Stage::DECAY ? Stage::SUSTAIN : Stage::IDLE);
+            } else {
+                m_level = m_from + m_step * static_cast<float>(m_elapsed);
+            }
+        }
+    }
+
+    Synth::Synth(unsigned int sampleRate, unsigned int channels, size_t voices, size_t eventCapacity)
+    : m_sampleRate(std::max(sampleRate, 1u))
+    , m_channels(std::max(channels, 1u))
+    {
+        m_voices.reserve(std::max<size_t>(voices, 1));
+        for (size_t i = 0; i < std::max<size_t>(voices, 1); ++i)
+            m_voices.push_back({Oscillator(m_sampleRate, 1), Adsr(m_sampleRate)});
+        m_events.reserve(eventCapacity);
+    }
+
+    void Synth::schedule(const NoteEvent& event) {
+        m_events.erase(m_events.begin(), m_events.begin() + static_cast<std::ptrdiff_t>(m_nextEvent));
+        m_nextEvent = 0;
+        const Pending pending{event, m_sequence++};
+        m_events.insert(std::upper_bound(m_events.begin(), m_events.end(), pending, event_before<Pending>), pending);
+    }
+
+    void Synth::schedule(std::span<const NoteEvent> events) {
+        m_events.erase(m_events.begin(), m_events.begin() + static_cast<std::ptrdiff_t>(m_nextEvent));
+        m_nextEvent = 0;
+        for (const auto& event : events)
+            m_events.push_back({event, m_sequence++});
+        // The sequence makes the order total, so an in-place sort keeps ties
+        // in scheduling order without stable_sort's buffer.
+        std::ranges::sort(m_events, event_before<Pending>);
+    }
+
+    void Synth::reset() noexcept {
+        for (auto& voice : m_voices)
+            voice.envelope.reset();
+        m_events.clear();
+        m_nextEvent = 0;
+    }
+
+    void Synth::render(std::span<float> out) noexcept {
+        const size_t frames = out.size() / m_channels;
+
+        for (size_t done = 0; done < frames;) {
+            while (m_nextEvent < m_events.size() && m_events[m_nextEvent].event.frame <= m_frame)
+                apply(m_events[m_nextEvent++].event);
+
+            size_t count = std::min(Oscillator::kBlockFrames, frames - done);
+            if (m_nextEvent < m_events.size())
+                count = static_cast<size_t>(std::min<uint64_t>(count, m_events[m_nextEvent].event.frame - m_frame));
+
+            renderSegment(out.data() + done * m_channels, count);
+            done += count;
+            m_frame += count;
+        }
+    }
+
+    size_t Synth::activeVoices() const noexcept {
+        return static_cast<size_t>(std::ranges::count_if(m_voices, [](const Voice& voice) {
+            return voice.envelope.active();
+        }));
+    }
+
+    bool Synth::idle() const noexcept {
+        return m_nextEvent == m_events.size() && activeVoices() == 0;
+    }
+
+    void Synth::apply(const NoteEvent& event) noexcept {
+        if (event.type == NoteEvent::Type::OFF) {
+            for (auto& voice : m_voices) {
+                if (voice.note == event.note && voice.envelope.active())
+                    voice.envelope.noteOff();
+            }
+            return;
+        }
+
+        Voice& voice = allocate();
+        voice.oscillator.setWaveType(m_waveType);
+        voice.oscillator.setFrequency(event.frequency);
+        voice.oscillator.setPhase(0.0);
+        voice.oscillator.setSeed(event.frame * 31 + static_cast<uint64_t>(event.note));
+        voice.envelope.setEnvelope(m_envelope);
+        voice.envelope.noteOn();
+        voice.note = event.note;
+        voice.gain = m_amplitude * event.velocity;
+        voice.started = event.frame;
+    }
+
+    Synth::Voice& Synth::allocate() noexcept {
+        Voice *quietest = nullptr;
+        Voice *oldest = &m_voices.front();
+
+        for (auto& voice : m_voices) {
+            if (!voice.envelope.active())
+                return voice;
+            if (voice.envelope.stage() == Adsr::Stage::RELEASE &&
+                (quietest == nullptr || voice.envelope.level() < quietest->envelope.level()))
+                quietest = &voice;
+            if (voice.started < oldest->started)
+                oldest = &voice;
+        }
+
+        return quietest != nullptr ? *quietest : *oldest;
+    }
+
+    void Synth::renderSegment(float *out, const size_t frames) noexcept {
+        std::fill_n(m_mix, frames, 0.f);
+
+        for (auto& voice : m_voices) {
+            if (!voice.envelope.active())
+                continue;
+
+            voice.oscillator.render({m_voiceBuffer, frames});
+            voice.envelope.process({m_voiceBuffer, frames});
+            for (size_t i = 0; i < frames; ++i)
+                m_mix[i] += voice.gain * m_voiceBuffer[i];
+        }
+
+        if (m_channels == 1) {
+            std::copy_n(m_mix, frames, out);
+        } else if (m_channels == 2) {
+            for (size_t i = 0; i < frames; ++i)
+                out[2 * i] = out[2 * i + 1] = m_mix[i];
+        } else {
+            for (size_t i = 0; i < frames; ++i, out += m_channels)
+                std::fill_n(out, m_channels, m_mix[i]);
+        }
+    }
+
+} // namespace SoundGenerator
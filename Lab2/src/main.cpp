@@ -1,64 +1,135 @@
-#include <wav_file.h>
+#include <wav_stream.h>
+#include <convolver.h>
 #include <filter.h>
-#include <fourier.h>
+
+#ifdef DSP_HAVE_ALSA
+#include <audio_engine.h>
+#include <audio_player.h>
+#include <audio_recorder.h>
+#endif
 
 #include <iostream>
 #include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <string_view>
+#include <thread>
 
 namespace {
-    constexpr int kSampleRate{ 48000 };
-    constexpr int kChannels{ 2 };
-    constexpr int kOutputSize{ kSampleRate / 2 };
+    constexpr int kOutputSize{ 48000 / 2 };
 
     constexpr int kLowerBoundHz{400};
     constexpr int kUpperBoundHz{1000};
 
+    constexpr float kAttenuationDb{60.f};
+    constexpr float kTransitionHz{100.f};
+    constexpr size_t kBlockSize{512};
+
     constexpr auto kInputFileName{"input.wav"};
     constexpr auto kOutputFileName{"output.wav"};
-}
-
-int main() {
-    WavFile file(kSampleRate, kChannels);
 
-    if (!file.load(kInputFileName))
-        return 1;
-
-    const auto data = file.data();
-
-    std::vector<float> left;
-    std::copy_if(data.begin(), data.end(), std::back_inserter(left), [i=0]([[maybe_unused]] const auto& elem) mutable {
-        return (i++ % 2) == 0;
-    });
+    constexpr unsigned int kLiveRate{48000};
+    constexpr unsigned int kLiveChannels{2};
+    constexpr size_t kLivePeriod{256};
+    constexpr int kLiveSeconds{10};
+
+    std::vector<float> design_kernel(const float sampleRate)
+    {
+        return filter::design_fir(filter::FilterType::BANDPASS,
+                                  filter::kaiser_taps(kAttenuationDb, kTransitionHz, sampleRate),
+                                  sampleRate, kLowerBoundHz, kUpperBoundHz,
+                                  utils::WindowType::KAISER, filter::kaiser_beta(kAttenuationDb));
+    }
 
-    std::vector<float> right;
-    std::copy_if(data.begin(), data.end(), std::back_inserter(right), [i=0]([[maybe_unused]] const auto& elem) mutable {
-        return (i++ % 2) != 0;
-    });
+#ifdef DSP_HAVE_ALSA
+    // Capture -> band-pass -> playback on the engine thread, one period at a time.
+    int filter_live()
+    {
+        AudioRecorder recorder(kLiveRate, kLiveChannels);
+        AudioPlayer player(kLiveRate, kLiveChannels);
+        recorder.setPeriod(kLivePeriod);
+        player.setPeriod(kLivePeriod);
+        if (!recorder.start() || !player.start())
+            return 1;
+        if (!recorder.link(player))
+            std::cerr << "Streams are not linked; capture and playback may drift apart." << std::endl;
+
+        const auto kernel = design_kernel(static_cast<float>(player.sampleRate()));
+        filter::Convolver convolver(kernel, kLivePeriod, kLiveChannels);
+
+        AudioEngine engine(kLiveChannels, kLivePeriod);
+        engine.setCallback([&convolver](std::span<float> period) { convolver.process(period, period); });
+        if (!engine.start(recorder, player))
+            return 1;
+
+        for (int second = 0; second < kLiveSeconds && engine.isRunning(); ++second) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            std::cout << "round trip " << engine.roundTripFrames() + static_cast<int64_t>(convolver.latency())
+                      << " frames (max " << engine.maxRoundTripFrames() + static_cast<int64_t>(convolver.latency())
+                      << "), xruns capture " << engine.captureXruns()
+                      << " playback " << engine.playbackXruns() << std::endl;
+        }
+
+        engine.stop();
+        std::cout << to_json(engine.stats(player)) << std::endl;
+        return engine.failed() ? 1 : 0;
+    }
+#endif
+}
 
-    auto complex_left = fourier::fft(left);
-    auto complex_right = fourier::fft(right);
+int main(int argc, char **argv) {
+    if (argc > 1 && std::string_view(argv[1]) == "live") {
+#ifdef DSP_HAVE_ALSA
+        return filter_live();
+#else
+        std::cerr << "Live mode needs ALSA." << std::endl;
+        return 1;
+#endif
+    }
 
-    const size_t N = complex_left.size();
-    const auto freqs = fourier::fft_freqs(N);
+    WavReader reader;
+    if (!reader.open(kInputFileName))
+        return 1;
 
-    complex_left = filter::filter(complex_left, freqs, kLowerBoundHz, kUpperBoundHz);
-    complex_right = filter::filter(complex_right, freqs, kLowerBoundHz, kUpperBoundHz);
+    const unsigned int channels = reader.channels();
+    const auto sampleRate = static_cast<float>(reader.sampleRate());
 
-    const auto output_left = fourier::ifft(complex_left);
-    const auto output_right = fourier::ifft(complex_right);
+    WavWriter writer(reader.sampleRate(), channels, reader.format().sampleFormat);
+    if (!writer.open(kOutputFileName))
+        return 1;
 
-    std::vector<float> output(2 * N, 0.0f);
-    for (size_t i = 0; i < N; ++i){
-        output[i * 2] = output_left[i];
-        output[i * 2 + 1] = output_right[i];
+    const auto kernel = design_kernel(sampleRate);
+    filter::Convolver convolver(kernel, kBlockSize, channels);
+
+    // Drop the block latency and the filter's group delay so the output
+    // lines up with the input, flushing the tail with as many silent frames.
+    const size_t delay = convolver.latency() + (kernel.size() - 1) / 2;
+    size_t skip = delay;
+    size_t tail = delay;
+
+    std::vector<float> block(kBlockSize * channels);
+    std::vector<float> filtered(block.size());
+    while (true) {
+        size_t frames = reader.read(block);
+        if (frames == 0) {
+            frames = std::min(tail, kBlockSize);
+            if (frames == 0)
+                break;
+            tail -= frames;
+            std::fill_n(block.begin(), frames * channels, 0.f);
+        }
+
+        const auto output = std::span(filtered).first(frames * channels);
+        convolver.process(std::span(block).first(frames * channels), output);
+
+        const size_t dropped = std::min(skip, frames);
+        skip -= dropped;
+        if (!writer.write(output.subspan(dropped * channels)))
+            return 1;
     }
 
-    file.clear();
-    file.append(output);
-
-    if (!file.save(kOutputFileName))
+    if (!writer.close())
         return 1;
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,66 @@
+#ifndef ASYNC_FILE_H
+#define ASYNC_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace utils {
+
+// File transfers at explicit offsets that run in the background: queue them
+// with read()/write() and collect the results, oldest first, with wait().
+// On Linux the transfers go through io_uring when the kernel allows it;
+// otherwise a worker thread performs them.
+class AsyncFile {
+public:
+    enum class Backend {
+        AUTO,
+        IO_URING,
+        THREAD,
+    };
+
+    enum class Mode {
+        READ,
+        // Creates the file or truncates an existing one.
+        WRITE,
+    };
+
+    class Engine;
+
+    explicit AsyncFile(Backend backend = Backend::AUTO) noexcept;
+    ~AsyncFile();
+
+    AsyncFile(const AsyncFile&) = delete;
+    AsyncFile& operator=(const AsyncFile&) = delete;
+
+    [[nodiscard]] bool open(const std::string& filename, Mode mode);
+    // Waits for the transfers still queued.
+    void close();
+
+    // The buffer has to stay valid, and unchanged for writes, until the
+    // transfer has been waited for.
+    [[nodiscard]] bool read(uint64_t offset, std::span<unsigned char> buffer);
+    [[nodiscard]] bool write(uint64_t offset, std::span<const unsigned char> buffer);
+
+    // Bytes moved by the oldest queued transfer: fewer than requested only
+    // for a read crossing the end of the file, -1 on failure.
+    int64_t wait();
+
+    [[nodiscard]] bool isOpen() const noexcept { return m_engine != nullptr; }
+    [[nodiscard]] size_t pending() const noexcept;
+    // File size when it was opened.
+    [[nodiscard]] uint64_t size() const noexcept { return m_size; }
+    // The backend in use once open; AUTO while closed.
+    [[nodiscard]] Backend backend() const noexcept;
+
+private:
+    std::unique_ptr<Engine> m_engine;
+    Backend m_requested;
+    uint64_t m_size{0};
+};
+
+} // namespace utils
+
+#endif //ASYNC_FILE_H
@@ -0,0 +1,187 @@
+#ifndef AUDIO_ENGINE_H
+#define AUDIO_ENGINE_H
+
+#include "playback_stats.h"
+#include "spsc_ring.h"
+#include "wav_stream.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Where an AudioEngine delivers its periods. write() is only called from the
+// engine thread and blocks until the device has taken the frames, which is
+// what paces the engine.
+class AudioSink {
+public:
+    virtual ~AudioSink() = default;
+
+    [[nodiscard]] virtual unsigned int channels() const noexcept = 0;
+    [[nodiscard]] virtual unsigned int sampleRate() const noexcept = 0;
+    // False on a failure the sink could not recover from.
+    [[nodiscard]] virtual bool write(std::span<const float> frames) = 0;
+
+    // Device buffer, primed with silence before a full-duplex run.
+    [[nodiscard]] virtual size_t bufferFrames() const noexcept { return 0; }
+    // Frames written but not yet played.
+    [[nodiscard]] virtual int64_t delayFrames() const noexcept { return 0; }
+    [[nodiscard]] virtual uint64_t xruns() const noexcept { return 0; }
+    // Safe to poll from any thread while another writes.
+    [[nodiscard]] virtual PlaybackStats stats() const noexcept { return {}; }
+};
+
+// Where a full-duplex AudioEngine takes its input. read() is only called from
+// the engine thread and blocks until the whole span is filled.
+class AudioSource {
+public:
+    virtual ~AudioSource() = default;
+
+    [[nodiscard]] virtual unsigned int channels() const noexcept = 0;
+    [[nodiscard]] virtual unsigned int sampleRate() const noexcept = 0;
+    // False on a failure the source could not recover from.
+    [[nodiscard]] virtual bool read(std::span<float> frames) = 0;
+
+    // Frames captured but not yet read.
+    [[nodiscard]] virtual int64_t delayFrames() const noexcept { return 0; }
+    [[nodiscard]] virtual uint64_t xruns() const noexcept { return 0; }
+};
+
+// Stand-in for a sound card that records into a WAV file. When paced, write()
+// sleeps so that frames are consumed at the sample rate, as a device would.
+class WavSink : public AudioSink {
+public:
+    explicit WavSink(unsigned int sampleRate = 48000, unsigned int channels = 2,
+                     SampleFormat format = SampleFormat::FLOAT32, bool paced = false);
+
+    [[nodiscard]] bool open(const std::string& filename);
+    [[nodiscard]] bool close();
+
+    [[nodiscard]] unsigned int channels() const noexcept override { return m_writer.channels(); }
+    [[nodiscard]] unsigned int sampleRate() const noexcept override { return m_writer.sampleRate(); }
+    [[nodiscard]] bool write(std::span<const float> frames) override;
+    [[nodiscard]] PlaybackStats stats() const noexcept override;
+
+private:
+    WavWriter m_writer;
+    bool m_paced;
+    PlaybackCounters m_counters;
+    std::chrono::steady_clock::time_point m_start;
+    uint64_t m_frames{0};
+};
+
+// Stand-in for a capture device that plays back a WAV file, paced like
+// WavSink when asked to. Past the end of the file it delivers silence.
+class WavSource : public AudioSource {
+public:
+    explicit WavSource(bool paced = false);
+
+    [[nodiscard]] bool open(const std::string& filename);
+    void close();
+    [[nodiscard]] bool finished() const noexcept { return m_finished.load(std::memory_order_acquire); }
+
+    [[nodiscard]] unsigned int channels() const noexcept override { return m_reader.channels(); }
+    [[nodiscard]] unsigned int sampleRate() const noexcept override { return m_reader.sampleRate(); }
+    [[nodiscard]] bool read(std::span<float> frames) override;
+
+private:
+    WavReader m_reader;
+    bool m_paced;
+    std::chrono::steady_clock::time_point m_start;
+    uint64_t m_frames{0};
+    std::atomic<bool> m_finished{false};
+};
+
+// Pull-model playback. A dedicated thread, raised to real-time priority when
+// the system allows it, renders one period at a time into the sink: the
+// period is taken from a lock-free ring fed by push(), then handed to the
+// callback, which may generate or modify it in place. The callback runs on
+// the engine thread and must neither allocate nor lock.
+//
+// Started with a source as well, the engine runs full duplex instead: each
+// period is read from the source, processed by the callback and written to
+// the sink on the same thread, and the ring is not used.
+class AudioEngine {
+public:
+    using Callback = std::function<void(std::span<float>)>;
+
+    explicit AudioEngine(unsigned int channels = 2, size_t periodFrames = 256, size_t ringFrames = 8192);
+    virtual ~AudioEngine();
+
+    AudioEngine(const AudioEngine&) = delete;
+    AudioEngine& operator=(const AudioEngine&) = delete;
+
+    // Only while stopped.
+    void setCallback(Callback callback);
+
+    // The sink must outlive the run and have the engine's channel count.
+    [[nodiscard]] bool start(AudioSink& sink);
+    // Full duplex; the source must also match the sink's sample rate.
+    [[nodiscard]] bool start(AudioSource& source, AudioSink& sink);
+    void stop();
+
+    // Producer side, from a single thread: queues whole interleaved frames
+    // and returns how many frames were accepted. Frames may be queued ahead
+    // of start().
+    size_t push(std::span<const float> frames) noexcept;
+    [[nodiscard]] size_t writableFrames() const noexcept { return m_ring.writable() / m_channels; }
+
+    // Frames between push() and the sink: the ring plus the period in hand.
+    [[nodiscard]] size_t latencyFrames() const noexcept { return m_ring.readable() / m_channels + m_periodFrames; }
+
+    [[nodiscard]] bool isRunning() const noexcept { return m_running.load(std::memory_order_acquire); }
+    // Whether the engine thread got real-time scheduling.
+    [[nodiscard]] bool isRealtime() const noexcept { return m_realtime.load(std::memory_order_acquire); }
+    // Whether the run ended because the sink failed.
+    [[nodiscard]] bool failed() const noexcept { return m_failed.load(std::memory_order_acquire); }
+    // Counters below cover the current or last run; start() resets them.
+    [[nodiscard]] uint64_t framesRendered() const noexcept { return m_frames.load(std::memory_order_relaxed); }
+    // Periods padded with silence because the ring ran dry after push() was
+    // first used in this run.
+    [[nodiscard]] uint64_t underruns() const noexcept { return m_underruns.load(std::memory_order_relaxed); }
+
+    // Full duplex only: device overruns and underruns reported by the source
+    // and the sink, and the capture delay before a read plus the playback
+    // delay after the matching write, latest and worst.
+    [[nodiscard]] uint64_t captureXruns() const noexcept { return m_captureXruns.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t playbackXruns() const noexcept { return m_playbackXruns.load(std::memory_order_relaxed); }
+    [[nodiscard]] int64_t roundTripFrames() const noexcept { return m_roundTrip.load(std::memory_order_relaxed); }
+    [[nodiscard]] int64_t maxRoundTripFrames() const noexcept { return m_maxRoundTrip.load(std::memory_order_relaxed); }
+
+    // The sink's counters plus the engine's underruns, capture xruns and
+    // callback durations; from any thread.
+    [[nodiscard]] PlaybackStats stats(const AudioSink& sink) const noexcept;
+
+    [[nodiscard]] unsigned int channels() const noexcept { return m_channels; }
+    [[nodiscard]] size_t periodFrames() const noexcept { return m_periodFrames; }
+
+private:
+    bool launch(AudioSource *source, AudioSink& sink);
+    void run(AudioSource *source, AudioSink& sink);
+    bool prime(AudioSink& sink);
+
+    const unsigned int m_channels;
+    const size_t m_periodFrames;
+    utils::SpscRing<float> m_ring;
+    std::vector<float> m_period;
+    Callback m_callback;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_realtime{false};
+    std::atomic<bool> m_failed{false};
+    std::atomic<bool> m_fed{false};
+    std::atomic<uint64_t> m_frames{0};
+    std::atomic<uint64_t> m_underruns{0};
+    std::atomic<uint64_t> m_captureXruns{0};
+    std::atomic<uint64_t> m_playbackXruns{0};
+    std::atomic<int64_t> m_roundTrip{0};
+    std::atomic<int64_t> m_maxRoundTrip{0};
+    DurationRecorder m_callbackTimes;
+};
+
+#endif //AUDIO_ENGINE_H
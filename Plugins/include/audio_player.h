@@ -1,30 +1,107 @@
 #ifndef AUDIOPLAYER_H
 #define AUDIOPLAYER_H
 
+#include "audio_engine.h"
+#include "playback_stats.h"
+#include "resampler.h"
+#include "sample_convert.h"
+#include "wav_format.h"
+
 #include <alsa/asoundlib.h>
+#include <chrono>
+#include <cstdint>
+#include <optional>
 #include <span>
 #include <string>
+#include <vector>
 
-class AudioPlayer
+// ALSA playback device. Either push audio with playSound() from the caller's
+// thread, or start() the device and hand it to an AudioEngine as its sink.
+// By default start() asks ALSA for about 50 ms of buffering and lets it
+// resample; setPeriod() or setMmap() switch to an explicit hw/sw setup
+// without ALSA resampling, for low-latency use. setResampling() converts the
+// rate in the player instead of in ALSA; so does any setup whose device
+// lacks the requested rate.
+class AudioPlayer : public AudioSink
 {
 public:
-    explicit AudioPlayer(unsigned int rate = 44100, unsigned int channels = 2) noexcept;
+    // Integer formats are converted from float on the way to the device.
+    explicit AudioPlayer(unsigned int rate = 48000, unsigned int channels = 2,
+                         SampleFormat format = SampleFormat::FLOAT32) noexcept;
     virtual ~AudioPlayer();
 
     [[nodiscard]] bool start();
     [[nodiscard]] bool stop();
 
-    void playSound(const std::span<float>& data) const;
+    void playSound(const std::span<float>& data);
+    // Blocks until every frame is queued, recovering from underruns. While
+    // resampling, frames go through in pieces of one period, into a buffer
+    // start() sized, so no call allocates.
+    [[nodiscard]] bool write(std::span<const float> frames) override;
     void setDevice(const std::string& device);
+    void setDither(DitherType type);
+    // Requested period size and count, applied by the next start(); the
+    // device may round both.
+    void setPeriod(size_t periodFrames, unsigned int periods = 2);
+    // Writes straight into the device ring (SND_PCM_ACCESS_MMAP_INTERLEAVED).
+    void setMmap(bool enabled);
+    // Applied by the next start(): the device runs at the nearest rate the
+    // hardware offers and write() converts from sampleRate() to it. The
+    // quality also applies when an explicit setup falls back to converting.
+    void setResampling(bool enabled, filter::ResampleQuality quality = filter::ResampleQuality::MEDIUM);
+
+    // Negotiated by start().
+    [[nodiscard]] size_t periodFrames() const noexcept { return m_periodFrames; }
+    [[nodiscard]] size_t bufferFrames() const noexcept override { return m_bufferFrames; }
+    [[nodiscard]] bool isMmap() const noexcept { return m_mmap; }
+    // Differs from sampleRate() only while the player resamples.
+    [[nodiscard]] unsigned int deviceRate() const noexcept { return m_deviceRate; }
+    // Time a frame spends in the device buffer once it is full.
+    [[nodiscard]] std::chrono::microseconds latency() const noexcept;
+
+    [[nodiscard]] unsigned int channels() const noexcept override { return m_channels; }
+    [[nodiscard]] unsigned int sampleRate() const noexcept override { return m_rate; }
+    // Frames queued ahead of the DAC at sampleRate(), sampled after each write.
+    [[nodiscard]] int64_t delayFrames() const noexcept override;
+    // Underruns since start().
+    [[nodiscard]] uint64_t xruns() const noexcept override { return m_counters.xruns(); }
+    // Counters since start(); to_json() dumps them.
+    [[nodiscard]] PlaybackStats stats() const noexcept override;
+
+    // Null while stopped; used by AudioRecorder::link().
+    [[nodiscard]] snd_pcm_t *handle() const noexcept { return m_handle; }
 
 private:
+    bool writeDevice(std::span<const float> samples);
+    bool writeFrames(std::span<const float> samples);
+    bool writeMmap(std::span<const float> samples);
+    bool recover(int err);
+
+    SampleFormat m_sampleFormat{SampleFormat::FLOAT32};
     snd_pcm_format_t m_format{SND_PCM_FORMAT_FLOAT};
     snd_pcm_t *m_handle{nullptr};
     std::string m_device{"default"};
 
     unsigned int m_channels{2};
-    unsigned int m_rate{44100};
+    unsigned int m_rate{48000};
+    unsigned int m_deviceRate{48000};
     bool m_isPlaying{false};
+
+    size_t m_requestedPeriod{0};
+    unsigned int m_requestedPeriods{2};
+    bool m_mmap{false};
+    size_t m_periodFrames{0};
+    size_t m_bufferFrames{0};
+    PlaybackCounters m_counters;
+
+    bool m_resampling{false};
+    filter::ResampleQuality m_quality{filter::ResampleQuality::MEDIUM};
+    std::optional<filter::Resampler> m_resampler;
+    std::vector<float> m_resampled;
+
+    Ditherer m_ditherer;
+    std::vector<float> m_scratch;
+    std::vector<unsigned char> m_buffer;
 };
 
 #endif //AUDIOPLAYER_H
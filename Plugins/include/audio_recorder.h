@@ -0,0 +1,79 @@
+#ifndef AUDIORECORDER_H
+#define AUDIORECORDER_H
+
+#include "audio_engine.h"
+#include "audio_player.h"
+#include "wav_format.h"
+
+#include <alsa/asoundlib.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// ALSA capture device, the counterpart of AudioPlayer. For full duplex, start
+// both, link() them so they share a clock start, and hand them to
+// AudioEngine::start(source, sink). Capture always uses an explicit hw/sw
+// setup without resampling; the period defaults to 256 frames.
+class AudioRecorder : public AudioSource
+{
+public:
+    // Integer formats are converted to float on the way from the device.
+    explicit AudioRecorder(unsigned int rate = 48000, unsigned int channels = 2,
+                           SampleFormat format = SampleFormat::FLOAT32) noexcept;
+    virtual ~AudioRecorder();
+
+    [[nodiscard]] bool start();
+    [[nodiscard]] bool stop();
+
+    void setDevice(const std::string& device);
+    // Applied by the next start(); the device may round both.
+    void setPeriod(size_t periodFrames, unsigned int periods = 2);
+    // After both devices are started: starting, stopping or recovering one
+    // stream then does the same to the other.
+    [[nodiscard]] bool link(AudioPlayer& player);
+
+    // Blocks until every frame is captured, recovering from overruns. Integer
+    // formats go through a one-period buffer start() sized, so no call
+    // allocates.
+    [[nodiscard]] bool read(std::span<float> frames) override;
+
+    [[nodiscard]] unsigned int channels() const noexcept override { return m_channels; }
+    [[nodiscard]] unsigned int sampleRate() const noexcept override { return m_rate; }
+    // Frames captured but not yet read, from the engine thread.
+    [[nodiscard]] int64_t delayFrames() const noexcept override;
+    // Overruns since start().
+    [[nodiscard]] uint64_t xruns() const noexcept override { return m_xruns.load(std::memory_order_relaxed); }
+
+    // Negotiated by start().
+    [[nodiscard]] size_t periodFrames() const noexcept { return m_periodFrames; }
+    [[nodiscard]] size_t bufferFrames() const noexcept { return m_bufferFrames; }
+    // Longest a frame can wait in the device buffer before it overruns.
+    [[nodiscard]] std::chrono::microseconds latency() const noexcept;
+
+private:
+    bool readFrames(unsigned char *bytes, size_t frames);
+    bool recover(int err);
+
+    SampleFormat m_sampleFormat{SampleFormat::FLOAT32};
+    snd_pcm_format_t m_format{SND_PCM_FORMAT_FLOAT};
+    snd_pcm_t *m_handle{nullptr};
+    std::string m_device{"default"};
+
+    unsigned int m_channels{2};
+    unsigned int m_rate{48000};
+    bool m_isRecording{false};
+    bool m_linked{false};
+
+    size_t m_requestedPeriod{256};
+    unsigned int m_requestedPeriods{2};
+    size_t m_periodFrames{0};
+    size_t m_bufferFrames{0};
+    std::atomic<uint64_t> m_xruns{0};
+
+    std::vector<unsigned char> m_buffer;
+};
+
+#endif //AUDIORECORDER_H
@@ -0,0 +1,68 @@
+#ifndef BIQUAD_H
+#define BIQUAD_H
+
+#include <span>
+#include <vector>
+
+namespace filter {
+
+// y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+struct Biquad {
+    float b0{1.f};
+    float b1{0.f};
+    float b2{0.f};
+    float a1{0.f};
+    float a2{0.f};
+};
+
+enum class BiquadType {
+    LOWPASS,
+    HIGHPASS,
+    BANDPASS,
+    NOTCH,
+    ALLPASS,
+    PEAK,
+    LOWSHELF,
+    HIGHSHELF,
+};
+
+// Audio EQ Cookbook (RBJ) sections. gainDb only applies to PEAK and shelves,
+// BANDPASS has unit gain at `frequency`.
+Biquad design_biquad(BiquadType type, float sampleRate, float frequency, float q = 0.70710678f, float gainDb = 0.f);
+
+// Band-pass cascades from an analog low-pass prototype of the given order,
+// giving `order` sections and a band-pass of order 2 * order. Band edges
+// are the -3 dB points for Butterworth and the ripple edges for Chebyshev
+// type I, whose passband peaks at unity.
+std::vector<Biquad> butterworth_bandpass(size_t order, float sampleRate, float lowerBound, float upperBound);
+std::vector<Biquad> chebyshev_bandpass(size_t order, float rippleDb, float sampleRate, float lowerBound, float upperBound);
+
+// Cascade of sections applied to interleaved channels. Channels are
+// processed in groups of kLanes with one SIMD lane per channel; state
+// persists between process() calls so blocks can be streamed.
+class BiquadCascade {
+public:
+    static constexpr size_t kLanes = 8;
+    static constexpr size_t kBlockFrames = 64;
+
+    BiquadCascade(std::vector<Biquad> sections, size_t channels = 1);
+
+    // in and out hold the same number of interleaved frames and may alias.
+    void process(std::span<const float> in, std::span<float> out);
+    void reset();
+
+    [[nodiscard]] size_t channels() const noexcept { return m_channels; }
+    [[nodiscard]] const std::vector<Biquad>& sections() const noexcept { return m_sections; }
+
+private:
+    std::vector<Biquad> m_sections;
+    size_t m_channels{0};
+    size_t m_groups{0};
+
+    // Transposed direct form II state [group][section][s1 | s2][lane].
+    std::vector<float> m_state;
+};
+
+} // namespace filter
+
+#endif //BIQUAD_H
@@ -0,0 +1,59 @@
+#ifndef CONVOLVER_H
+#define CONVOLVER_H
+
+#include "fft_plan.h"
+
+#include <span>
+#include <vector>
+
+namespace filter {
+
+// Uniformly partitioned overlap-save convolution. The kernel is split into
+// blocks of blockSize taps whose spectra are computed once; every input block
+// is transformed once and multiplied against all partitions through a
+// frequency-domain delay line, so the cost per block is constant and only
+// grows linearly with the number of partitions.
+// Samples are interleaved across `channels`, which share the kernel spectra.
+// Output is the convolution delayed by latency() == blockSize frames.
+class Convolver {
+public:
+    Convolver(std::span<const float> kernel, size_t blockSize = 512, size_t channels = 1);
+
+    // in and out hold the same number of interleaved frames and may alias.
+    void process(std::span<const float> in, std::span<float> out);
+    void reset();
+
+    [[nodiscard]] size_t blockSize() const noexcept { return m_blockSize; }
+    [[nodiscard]] size_t channels() const noexcept { return m_channels; }
+    [[nodiscard]] size_t partitions() const noexcept { return m_partitions; }
+    [[nodiscard]] size_t latency() const noexcept { return m_blockSize; }
+
+private:
+    void processBlock();
+
+    size_t m_blockSize{0};
+    size_t m_channels{0};
+    size_t m_partitions{0};
+    size_t m_bins{0};
+    fourier::RealFftPlan m_plan;
+
+    // Kernel spectra [partition][bin], and the delay line of input spectra
+    // [channel][slot][bin] where slot m_head holds the newest block.
+    std::vector<fourier::complex> m_kernel;
+    std::vector<fourier::complex> m_delayLine;
+    size_t m_head{0};
+
+    // Per channel: the last two input blocks, the pending input block and
+    // the output block being read out while the next one fills.
+    std::vector<float> m_history;
+    std::vector<float> m_input;
+    std::vector<float> m_output;
+    size_t m_filled{0};
+
+    std::vector<fourier::complex> m_sum;
+    std::vector<float> m_frame;
+};
+
+} // namespace filter
+
+#endif //CONVOLVER_H
@@ -0,0 +1,132 @@
+#ifndef FFT_PLAN_H
+#define FFT_PLAN_H
+
+#include "utils.h"
+
+#include <span>
+#include <vector>
+
+namespace fourier {
+
+using complex = utils::complex;
+
+enum class SimdLevel {
+    SCALAR,
+    SSE2,
+    AVX2,
+    NEON,
+};
+
+SimdLevel best_simd_level();
+
+// Plans created for sizes above the threshold use the four-step algorithm.
+void set_four_step_threshold(size_t size) noexcept;
+size_t four_step_threshold() noexcept;
+
+// Precomputed state for a transform of fixed size.
+// execute() and executeInverse() never allocate; inverse output is unscaled.
+// Factors of two run as radix-4 passes over split real/imaginary buffers
+// using the requested instruction set, or the best available one if
+// unsupported, followed by radix-3/5/7 passes. Sizes with other prime
+// factors go through Bluestein's algorithm. Powers of two above
+// four_step_threshold() are split into row and column transforms that fit
+// in cache and only keep O(sqrt(size)) scratch.
+class FftPlan {
+public:
+    explicit FftPlan(size_t size, SimdLevel simd = best_simd_level());
+
+    // Input shorter than size() is zero-padded, out must hold size() values.
+    // in and out may refer to the same buffer.
+    void execute(std::span<const complex> in, std::span<complex> out);
+    void executeInverse(std::span<const complex> in, std::span<complex> out);
+    void execute(std::span<complex> data) { execute(data, data); }
+    void executeInverse(std::span<complex> data) { executeInverse(data, data); }
+
+    [[nodiscard]] size_t size() const noexcept { return m_size; }
+    [[nodiscard]] SimdLevel simdLevel() const noexcept { return m_simd; }
+    [[nodiscard]] bool isFourStep() const noexcept { return !m_steps.empty(); }
+    [[nodiscard]] bool isBluestein() const noexcept { return !m_chirp.empty(); }
+
+private:
+    using Radix4Pass = void (*)(float *re, float *im, size_t size, size_t quarter, const float *twiddles);
+
+    struct OddStage {
+        size_t radix{0};
+        size_t span{0};
+        size_t twiddles{0};
+        size_t roots{0};
+    };
+
+    FftPlan(size_t size, SimdLevel simd, bool allowFourStep);
+
+    void prepareDirect(const std::vector<size_t>& oddRadices);
+    void prepareFourStep();
+    void prepareBluestein();
+
+    template<typename Load, typename Store>
+    void run(const Load& load, const Store& store, bool inverse);
+    void transform(std::span<const complex> in, std::span<complex> out, bool inverse);
+    void transformFourStep(std::span<const complex> in, std::span<complex> out, bool inverse);
+    void transformBluestein(std::span<const complex> in, std::span<complex> out, bool inverse);
+    void transpose(std::span<complex> data);
+
+    size_t m_size{0};
+    int m_bits{0};
+    SimdLevel m_simd{SimdLevel::SCALAR};
+    Radix4Pass m_pass{nullptr};
+    std::vector<float> m_twiddles;
+    std::vector<unsigned int> m_reversal;
+    std::vector<float> m_re;
+    std::vector<float> m_im;
+
+    // Radix-3/5/7 passes after the power-of-two part, with twiddles in
+    // m_oddTwiddles and DFT matrix entries cos/sin(2 pi p q / radix) in m_roots.
+    std::vector<OddStage> m_oddStages;
+    std::vector<float> m_oddTwiddles;
+    std::vector<float> m_roots;
+
+    // Four-step state: column transform of m_rows points, row transform of
+    // m_cols points and twiddles w^(c * k) = m_coarse[e / m_cols] * m_fine[e % m_cols].
+    size_t m_rows{0};
+    size_t m_cols{0};
+    std::vector<FftPlan> m_steps;
+    std::vector<complex> m_coarse;
+    std::vector<complex> m_fine;
+    std::vector<complex> m_block;
+    std::vector<size_t> m_cycles;
+
+    // Bluestein state: chirp exp(-i pi n^2 / N) and the spectrum of its
+    // conjugate, convolved through the power-of-two plan in m_convolution.
+    std::vector<FftPlan> m_convolution;
+    std::vector<complex> m_chirp;
+    std::vector<complex> m_kernel;
+    std::vector<complex> m_work;
+};
+
+// Real-input transform of size N returning the N / 2 + 1 non-redundant bins.
+// Even sizes run through a complex transform of size N / 2, odd sizes
+// through a full complex transform.
+class RealFftPlan {
+public:
+    explicit RealFftPlan(size_t size, SimdLevel simd = best_simd_level());
+
+    // out must hold bins() values, in shorter than size() is zero-padded.
+    void execute(std::span<const float> in, std::span<complex> out);
+    // in holds bins() values, out must hold size() samples. Output is unscaled.
+    void executeInverse(std::span<const complex> in, std::span<float> out);
+
+    [[nodiscard]] size_t size() const noexcept { return m_size; }
+    [[nodiscard]] size_t bins() const noexcept { return m_size / 2 + 1; }
+    [[nodiscard]] SimdLevel simdLevel() const noexcept { return m_plan.simdLevel(); }
+
+private:
+    size_t m_size{0};
+    FftPlan m_plan;
+    std::vector<complex> m_twiddles;
+    std::vector<complex> m_packed;
+    std::vector<complex> m_unpacked;
+};
+
+} // namespace fourier
+
+#endif //FFT_PLAN_H
@@ -2,6 +2,7 @@
 #define FILTER_H
 
 #include "utils.h"
+#include "window.h"
 
 #include <span>
 #include <vector>
@@ -12,6 +13,25 @@ using namespace utils;
 
 std::vector<complex> filter(std::span<const complex> input, std::span<const float> freqs, int lowerBound, int upperBound);
 
+enum class FilterType {
+    LOWPASS,
+    HIGHPASS,
+    BANDPASS,
+    NOTCH,
+};
+
+// Linear-phase windowed-sinc FIR with a delay of (taps - 1) / 2 samples.
+// Cutoffs are in Hz; LOWPASS and HIGHPASS only use `lower`. HIGHPASS and
+// NOTCH need an odd length, so an even `taps` is rounded up. The response
+// is normalised to unit gain in the centre of the passband.
+std::vector<float> design_fir(FilterType type, size_t taps, float sampleRate, float lower, float upper = 0.f,
+                              WindowType window = WindowType::KAISER, float kaiserBeta = kDefaultKaiserBeta);
+
+// Kaiser design rules: window beta for a stopband attenuation in dB, and the
+// number of taps reaching it over a transition band of transitionHz.
+float kaiser_beta(float attenuationDb);
+size_t kaiser_taps(float attenuationDb, float transitionHz, float sampleRate);
+
 }
 
 #endif //FILTER_H
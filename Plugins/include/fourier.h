@@ -1,6 +1,8 @@
 #ifndef FOURIER_H
 #define FOURIER_H
 
+#include "fft_plan.h"
+#include "thread_pool.h"
 #include "utils.h"
 
 #include <span>
@@ -18,6 +20,32 @@ std::vector<complex> fft(std::span<const float> inputs);
 std::vector<float> ifft(std::span<const complex> inputs);
 std::vector<float> fft_freqs(size_t N, float sampleRate = utils::kDefaultSampleRate);
 
+// Half spectrum of real input of length N: N / 2 + 1 bins.
+std::vector<complex> rfft(std::span<const float> inputs);
+std::vector<float> irfft(std::span<const complex> inputs, size_t N);
+std::vector<float> rfft_freqs(size_t N, float sampleRate = utils::kDefaultSampleRate);
+
+// Layout of `count` signals in one buffer: sample n of signal c is at
+// c * distance + n * stride. Interleaved channels use distance 1 and
+// stride = channels, overlapping frames use distance = hop and stride 1.
+struct Batch {
+    size_t count{0};
+    size_t distance{0};
+    size_t stride{1};
+};
+
+// Independent transforms of plan.size() samples per signal, split across the
+// pool. Spectra are stored back to back, plan.bins() or plan.size() each.
+// The inverse reads that layout and is scaled by 1 / plan.size().
+void fft_many(const RealFftPlan& plan, std::span<const float> input, const Batch& batch,
+              std::span<complex> output, utils::ThreadPool& pool = utils::ThreadPool::global());
+void ifft_many(const RealFftPlan& plan, std::span<const complex> input, std::span<float> output,
+               const Batch& batch, utils::ThreadPool& pool = utils::ThreadPool::global());
+void fft_many(const FftPlan& plan, std::span<const complex> input, const Batch& batch,
+              std::span<complex> output, utils::ThreadPool& pool = utils::ThreadPool::global());
+void ifft_many(const FftPlan& plan, std::span<const complex> input, std::span<complex> output,
+               const Batch& batch, utils::ThreadPool& pool = utils::ThreadPool::global());
+
 }
 
 #endif //FOURIER_H
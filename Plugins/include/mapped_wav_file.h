@@ -0,0 +1,73 @@
+#ifndef MAPPED_WAV_FILE_H
+#define MAPPED_WAV_FILE_H
+
+#include "wav_format.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <type_traits>
+
+// Read-only view of a WAV file mapped into memory. Samples are used in
+// place, without reading the file up front or keeping a converted copy;
+// pages are faulted in as they are touched.
+class MappedWavFile {
+public:
+    MappedWavFile() = default;
+    ~MappedWavFile();
+
+    MappedWavFile(const MappedWavFile&) = delete;
+    MappedWavFile& operator=(const MappedWavFile&) = delete;
+    MappedWavFile(MappedWavFile&& other) noexcept;
+    MappedWavFile& operator=(MappedWavFile&& other) noexcept;
+
+    [[nodiscard]] bool open(const std::string& filename);
+    void close() noexcept;
+
+    // Packed interleaved samples straight from the mapping; valid until close().
+    [[nodiscard]] std::span<const unsigned char> bytes() const noexcept { return m_bytes; }
+
+    // Typed view for int16_t (PCM16), int32_t (PCM32) or float (FLOAT32).
+    // Empty if the file holds another format or the data is misaligned.
+    template<typename T>
+    [[nodiscard]] std::span<const T> view() const noexcept;
+    [[nodiscard]] std::span<const int16_t> samples() const noexcept { return view<int16_t>(); }
+
+    // Converts up to out.size() / channels() frames starting at firstFrame
+    // and returns how many were converted.
+    size_t read(size_t firstFrame, std::span<float> out) const;
+
+    // Hints that frames from firstFrame on will be needed soon.
+    void prefetch(size_t firstFrame, size_t frames) const;
+
+    [[nodiscard]] bool isOpen() const noexcept { return m_mapping != nullptr; }
+    [[nodiscard]] const WavFormat& format() const noexcept { return m_format; }
+    [[nodiscard]] unsigned int channels() const noexcept { return m_format.channels; }
+    [[nodiscard]] unsigned int sampleRate() const noexcept { return m_format.sampleRate; }
+    [[nodiscard]] size_t frames() const noexcept { return isOpen() ? m_bytes.size() / m_format.frameBytes() : 0; }
+
+private:
+    void *m_mapping{nullptr};
+    size_t m_length{0};
+    std::span<const unsigned char> m_bytes;
+    WavFormat m_format;
+};
+
+template<typename T>
+std::span<const T> MappedWavFile::view() const noexcept
+{
+    static_assert(std::is_same_v<T, int16_t> || std::is_same_v<T, int32_t> || std::is_same_v<T, float>);
+
+    constexpr SampleFormat format = std::is_same_v<T, int16_t> ? SampleFormat::PCM16
+                                  : std::is_same_v<T, int32_t> ? SampleFormat::PCM32
+                                  : SampleFormat::FLOAT32;
+
+    const auto address = reinterpret_cast<std::uintptr_t>(m_bytes.data());
+    if (!isOpen() || m_format.sampleFormat != format || address % alignof(T) != 0)
+        return {};
+
+    return {reinterpret_cast<const T *>(m_bytes.data()), m_bytes.size() / sizeof(T)};
+}
+
+#endif //MAPPED_WAV_FILE_H
@@ -0,0 +1,85 @@
+#ifndef PLAYBACK_STATS_H
+#define PLAYBACK_STATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Durations over power-of-two microsecond buckets: bucket 0 counts those
+// under 1 us, bucket i those in [2^(i-1), 2^i) us, and the last one everything
+// from 2^(kBuckets-2) us (about 0.26 s) up.
+struct DurationHistogram {
+    static constexpr size_t kBuckets{ 20 };
+
+    std::array<uint64_t, kBuckets> counts{};
+    uint64_t count{0};
+    std::chrono::nanoseconds total{0};
+    std::chrono::nanoseconds max{0};
+
+    // Upper edge of the bucket that holds the given fraction (0..1) of the
+    // samples, capped at the maximum.
+    [[nodiscard]] std::chrono::microseconds percentile(double fraction) const noexcept;
+};
+
+// Fills a DurationHistogram from one thread without locking or allocating,
+// while snapshot() may be taken from any other.
+class DurationRecorder {
+public:
+    void record(std::chrono::nanoseconds duration) noexcept;
+    void reset() noexcept;
+    [[nodiscard]] DurationHistogram snapshot() const noexcept;
+
+private:
+    std::array<std::atomic<uint64_t>, DurationHistogram::kBuckets> m_counts{};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<int64_t> m_total{0};
+    std::atomic<int64_t> m_max{0};
+};
+
+// Point-in-time view of a playback path, for polling or to_json(). Sinks fill
+// the device fields; AudioEngine::stats() adds its own.
+struct PlaybackStats {
+    unsigned int sampleRate{0};
+    size_t periodFrames{0};
+    size_t bufferFrames{0};
+
+    uint64_t framesWritten{0};
+    uint64_t xruns{0};
+    // Frames queued ahead of the DAC after the latest write.
+    int64_t delayFrames{0};
+    // Time each write spent blocked on the device.
+    DurationHistogram blocked;
+
+    // Engine only.
+    uint64_t underruns{0};
+    uint64_t captureXruns{0};
+    DurationHistogram callback;
+};
+
+std::string to_json(const PlaybackStats& stats);
+
+// The device counters of PlaybackStats, updated by the thread that writes to
+// a sink and read from any other.
+class PlaybackCounters {
+public:
+    void recordWrite(size_t frames, std::chrono::nanoseconds blocked) noexcept;
+    void recordXrun() noexcept { m_xruns.fetch_add(1, std::memory_order_relaxed); }
+    void setDelay(int64_t frames) noexcept { m_delay.store(frames, std::memory_order_relaxed); }
+    // Only while nothing writes.
+    void reset() noexcept;
+
+    [[nodiscard]] uint64_t xruns() const noexcept { return m_xruns.load(std::memory_order_relaxed); }
+    [[nodiscard]] int64_t delay() const noexcept { return m_delay.load(std::memory_order_relaxed); }
+    void collect(PlaybackStats& stats) const noexcept;
+
+private:
+    std::atomic<uint64_t> m_frames{0};
+    std::atomic<uint64_t> m_xruns{0};
+    std::atomic<int64_t> m_delay{0};
+    DurationRecorder m_blocked;
+};
+
+#endif //PLAYBACK_STATS_H
@@ -0,0 +1,81 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace filter {
+
+// Stopband attenuation and passband edge (as a fraction of the lower
+// Nyquist frequency): 60 dB / 0.80, 90 dB / 0.90 and 120 dB / 0.95.
+enum class ResampleQuality {
+    LOW,
+    MEDIUM,
+    HIGH,
+};
+
+// Streaming sample-rate converter for interleaved frames at any rational
+// ratio. A Kaiser-windowed sinc is tabulated as a polyphase bank with one row
+// per output phase of the reduced ratio; ratios with more phases than
+// kMaxPhases interpolate between the two nearest rows. Output frame n is the
+// input at time n * inputRate / outputRate, with no delay to compensate.
+class Resampler {
+public:
+    static constexpr size_t kMaxPhases = 512;
+
+    Resampler(unsigned int inputRate, unsigned int outputRate, size_t channels = 1,
+              ResampleQuality quality = ResampleQuality::MEDIUM);
+
+    // Consumes all of in and returns the number of frames written to out,
+    // which must hold maxOutputFrames(in.size() / channels()) frames.
+    size_t process(std::span<const float> in, std::span<float> out);
+    // Writes the frames still held back for lookahead, so that the whole
+    // stream yields ceil(input * outputRate / inputRate) frames, then
+    // resets. out must hold maxOutputFrames(0) frames.
+    size_t flush(std::span<float> out);
+    void reset();
+
+    [[nodiscard]] size_t maxOutputFrames(size_t inputFrames) const noexcept;
+
+    [[nodiscard]] unsigned int inputRate() const noexcept { return m_inputRate; }
+    [[nodiscard]] unsigned int outputRate() const noexcept { return m_outputRate; }
+    [[nodiscard]] size_t channels() const noexcept { return m_channels; }
+    [[nodiscard]] size_t taps() const noexcept { return m_taps; }
+    [[nodiscard]] size_t phases() const noexcept { return m_phases; }
+    // Input frames process() holds back before the matching output appears.
+    [[nodiscard]] size_t latency() const noexcept { return m_taps / 2; }
+
+private:
+    size_t render(std::span<float> out, uint64_t limit);
+
+    unsigned int m_inputRate{0};
+    unsigned int m_outputRate{0};
+    size_t m_channels{0};
+
+    // Reduced ratio: each output advances the input by m_down / m_up frames.
+    uint64_t m_up{1};
+    uint64_t m_down{1};
+    size_t m_taps{0};
+    size_t m_phases{0};
+    // (m_phases + 1) rows of m_taps coefficients; the last row is phase 1.
+    std::vector<float> m_table;
+
+    // Planar input history, m_capacity frames per channel.
+    std::vector<float> m_history;
+    size_t m_capacity{0};
+    size_t m_size{0};
+    size_t m_index{0};
+    uint64_t m_phase{0};
+
+    uint64_t m_inputFrames{0};
+    uint64_t m_outputFrames{0};
+};
+
+// Whole-signal conversion, including the flushed tail.
+std::vector<float> resample(std::span<const float> input, unsigned int inputRate, unsigned int outputRate,
+                            size_t channels = 1, ResampleQuality quality = ResampleQuality::MEDIUM);
+
+} // namespace filter
+
+#endif //RESAMPLER_H
@@ -0,0 +1,56 @@
+#ifndef SAMPLE_CONVERT_H
+#define SAMPLE_CONVERT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Block conversion between float samples in [-1, 1] and integer PCM. An n-bit
+// integer uses the symmetric scale 2^(n-1) - 1; float input saturates at full
+// scale (NaN goes to negative full scale) and rounds to nearest. Integer
+// pointers need not be aligned, and 24-bit samples are packed little-endian.
+
+void float_to_int16(std::span<const float> in, int16_t *out) noexcept;
+void float_to_int24(std::span<const float> in, unsigned char *out) noexcept;
+void float_to_int32(std::span<const float> in, int32_t *out) noexcept;
+
+void int16_to_float(const int16_t *in, std::span<float> out) noexcept;
+void int24_to_float(const unsigned char *in, std::span<float> out) noexcept;
+void int32_to_float(const int32_t *in, std::span<float> out) noexcept;
+
+enum class DitherType {
+    NONE,
+    TPDF,
+    // TPDF with second-order error feedback, moving the requantization noise
+    // towards Nyquist: the noise transfer function is (1 - z^-1)^2.
+    SHAPED,
+};
+
+// Requantizes interleaved float samples onto the grid of a bits-bit integer
+// format before conversion, so that the converters above only round values
+// that are already exact. Each channel keeps its own error state.
+class Ditherer {
+public:
+    explicit Ditherer(unsigned int channels = 2, unsigned int bits = 16,
+                      DitherType type = DitherType::TPDF, uint32_t seed = 1) noexcept;
+
+    void process(std::span<float> samples) noexcept;
+    void reset() noexcept;
+
+    [[nodiscard]] DitherType type() const noexcept { return m_type; }
+    [[nodiscard]] unsigned int channels() const noexcept { return m_channels; }
+    [[nodiscard]] unsigned int bits() const noexcept { return m_bits; }
+
+private:
+    std::vector<float> m_error;
+    DitherType m_type;
+    unsigned int m_channels;
+    unsigned int m_bits;
+    float m_scale;
+    uint32_t m_seed;
+    uint64_t m_state;
+    size_t m_channel{0};
+};
+
+#endif //SAMPLE_CONVERT_H
@@ -0,0 +1,115 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace utils {
+
+// Bounded FIFO between exactly one producer thread and one consumer thread.
+// Both sides are wait-free: no locks, no allocation after construction, and
+// a call never waits for the other side. Capacity is rounded up to a power
+// of two.
+template<typename T>
+class SpscRing {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    explicit SpscRing(size_t capacity)
+    : m_data(std::bit_ceil(std::max<size_t>(capacity, 2)))
+    , m_mask(m_data.size() - 1)
+    {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer: copies as much of data as fits and returns how many items that was.
+    size_t write(std::span<const T> data) noexcept
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (capacity() - (tail - m_headCache) < data.size())
+            m_headCache = m_head.load(std::memory_order_acquire);
+
+        const size_t count = std::min(data.size(), capacity() - (tail - m_headCache));
+        if (count == 0)
+            return 0;
+
+        copyIn(data.data(), tail, count);
+        m_tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer: fills as much of out as is available and returns how many items that was.
+    size_t read(std::span<T> out) noexcept
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (m_tailCache - head < out.size())
+            m_tailCache = m_tail.load(std::memory_order_acquire);
+
+        const size_t count = std::min(out.size(), m_tailCache - head);
+        if (count == 0)
+            return 0;
+
+        copyOut(out.data(), head, count);
+        m_head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // Snapshots: readable() can only grow until the consumer reads, writable()
+    // until the producer writes.
+    [[nodiscard]] size_t readable() const noexcept
+    {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+    [[nodiscard]] size_t writable() const noexcept { return capacity() - readable(); }
+    [[nodiscard]] size_t capacity() const noexcept { return m_data.size(); }
+
+    // Only while neither side is running.
+    void reset() noexcept
+    {
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+        m_headCache = 0;
+        m_tailCache = 0;
+    }
+
+private:
+    static constexpr size_t kCacheLine{ 64 };
+
+    // Positions grow without bound and are masked on access, so a full ring
+    // and an empty one stay distinguishable.
+    void copyIn(const T *data, const size_t position, const size_t count) noexcept
+    {
+        const size_t start = position & m_mask;
+        const size_t first = std::min(count, capacity() - start);
+        std::memcpy(m_data.data() + start, data, first * sizeof(T));
+        std::memcpy(m_data.data(), data + first, (count - first) * sizeof(T));
+    }
+
+    void copyOut(T *data, const size_t position, const size_t count) const noexcept
+    {
+        const size_t start = position & m_mask;
+        const size_t first = std::min(count, capacity() - start);
+        std::memcpy(data, m_data.data() + start, first * sizeof(T));
+        std::memcpy(data + first, m_data.data(), (count - first) * sizeof(T));
+    }
+
+    std::vector<T> m_data;
+    const size_t m_mask;
+
+    // Each side owns one index and a cached copy of the other's.
+    alignas(kCacheLine) std::atomic<size_t> m_head{0};
+    size_t m_tailCache{0};
+    alignas(kCacheLine) std::atomic<size_t> m_tail{0};
+    size_t m_headCache{0};
+};
+
+} // namespace utils
+
+#endif //SPSC_RING_H
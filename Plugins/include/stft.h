@@ -0,0 +1,63 @@
+#ifndef STFT_H
+#define STFT_H
+
+#include "fft_plan.h"
+#include "window.h"
+
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace fourier {
+
+// Streaming short-time Fourier transform with weighted overlap-add resynthesis.
+// Frames of frameSize samples start every hop samples; each windowed frame's
+// half spectrum (frameSize / 2 + 1 bins) is handed to the processor, then
+// windowed again and overlap-added. Output is divided by the summed squared
+// window, so an untouched spectrum reconstructs the input to float rounding;
+// window and hop must keep that sum non-zero everywhere (asserted).
+// Output lags input by latency() samples; flush() emits the remainder, so in
+// total exactly as many samples come out as went in. Memory is O(frameSize).
+class Stft {
+public:
+    using Processor = std::function<void(std::span<complex> spectrum)>;
+
+    Stft(size_t frameSize, size_t hop, utils::WindowType window = utils::WindowType::HANN,
+         float kaiserBeta = utils::kDefaultKaiserBeta);
+
+    void setProcessor(Processor processor) { m_processor = std::move(processor); }
+
+    // Appends every finished output sample to output.
+    void push(std::span<const float> input, std::vector<float>& output);
+    // Completes the pending frames with silence and starts a new stream.
+    void flush(std::vector<float>& output);
+    void reset();
+
+    [[nodiscard]] size_t frameSize() const noexcept { return m_frameSize; }
+    [[nodiscard]] size_t hop() const noexcept { return m_hop; }
+    [[nodiscard]] size_t bins() const noexcept { return m_plan.bins(); }
+    [[nodiscard]] size_t latency() const noexcept { return m_frameSize - m_hop; }
+
+private:
+    void processFrame(std::vector<float>& output);
+
+    size_t m_frameSize{0};
+    size_t m_hop{0};
+    RealFftPlan m_plan;
+    Processor m_processor;
+
+    std::vector<float> m_window;
+    std::vector<float> m_norm;
+    std::vector<float> m_input;
+    std::vector<float> m_frame;
+    std::vector<float> m_overlap;
+    std::vector<complex> m_spectrum;
+
+    size_t m_filled{0};
+    size_t m_skip{0};
+    size_t m_pending{0};
+};
+
+} // namespace fourier
+
+#endif //STFT_H
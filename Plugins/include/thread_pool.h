@@ -0,0 +1,54 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace utils {
+
+// Fixed set of worker threads running one parallelFor() at a time.
+// The calling thread takes part in the work, so a pool of size 0 runs
+// everything inline. parallelFor() must not be called from inside a task.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Calls task(i) for every i in [0, count) and returns once all are done.
+    void parallelFor(size_t count, const std::function<void(size_t)>& task);
+
+    // Number of threads taking part in parallelFor(), the caller included.
+    [[nodiscard]] size_t concurrency() const noexcept { return m_workers.size() + 1; }
+
+    static ThreadPool& global();
+
+private:
+    void workerLoop();
+    void runTasks();
+
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_submitMutex;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+
+    const std::function<void(size_t)> *m_task{nullptr};
+    size_t m_count{0};
+    std::atomic<size_t> m_next{0};
+    size_t m_active{0};
+    size_t m_generation{0};
+    bool m_stopping{false};
+};
+
+} // namespace utils
+
+#endif //THREAD_POOL_H
@@ -1,6 +1,10 @@
 #ifndef WAVFILE_H
 #define WAVFILE_H
 
+#include "resampler.h"
+#include "sample_convert.h"
+#include "wav_format.h"
+
 #include <string>
 #include <vector>
 #include <span>
@@ -8,20 +12,34 @@
 
 class WavFile {
 public:
-    explicit WavFile(unsigned int sampleRate = 48000, unsigned int channels = 2) noexcept;
+    explicit WavFile(unsigned int sampleRate = 48000, unsigned int channels = 2,
+                     SampleFormat format = SampleFormat::PCM16) noexcept;
     virtual ~WavFile() = default;
 
     void clear();
     void append(const std::span<const float>& data);
+    // Dither used by append() for integer formats; NONE by default.
+    void setDither(DitherType type);
     [[nodiscard]] std::vector<float> data() const;
 
     [[nodiscard]] bool save(const std::string& filename) const;
-    [[nodiscard]] bool load(const std::string& filename);
+    // Takes channels, sample rate and sample format from the file; with a
+    // non-zero sampleRate the samples are then converted to that rate.
+    [[nodiscard]] bool load(const std::string& filename, unsigned int sampleRate = 0,
+                            filter::ResampleQuality quality = filter::ResampleQuality::MEDIUM);
+    // Converts the samples held, re-encoding them in the current format.
+    void resample(unsigned int sampleRate, filter::ResampleQuality quality = filter::ResampleQuality::MEDIUM);
+
+    [[nodiscard]] unsigned int channels() const noexcept { return m_format.channels; }
+    [[nodiscard]] unsigned int sampleRate() const noexcept { return m_format.sampleRate; }
+    [[nodiscard]] SampleFormat sampleFormat() const noexcept { return m_format.sampleFormat; }
 
 private:
-    std::vector<int16_t> m_buffer;
-    const unsigned int m_channels;
-    const unsigned int m_sampleRate;
+    // Samples packed in the file's representation.
+    std::vector<unsigned char> m_buffer;
+    std::vector<float> m_scratch;
+    WavFormat m_format;
+    Ditherer m_ditherer;
 };
 
 #endif //WAVFILE_H
@@ -0,0 +1,57 @@
+#ifndef WAV_FORMAT_H
+#define WAV_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <span>
+#include <vector>
+
+enum class SampleFormat {
+    PCM16,
+    PCM24,
+    PCM32,
+    FLOAT32,
+};
+
+size_t bytes_per_sample(SampleFormat format) noexcept;
+
+struct WavFormat {
+    SampleFormat sampleFormat{SampleFormat::PCM16};
+    unsigned int channels{2};
+    unsigned int sampleRate{48000};
+
+    [[nodiscard]] size_t frameBytes() const noexcept { return channels * bytes_per_sample(sampleFormat); }
+};
+
+// Where the samples of a parsed file live.
+struct WavLayout {
+    WavFormat format;
+    uint64_t dataOffset{0};
+    uint64_t dataSize{0};
+    bool rf64{false};
+
+    [[nodiscard]] uint64_t frames() const noexcept { return dataSize / format.frameBytes(); }
+};
+
+// Walks the chunks of a RIFF or RF64 WAVE file, skipping unknown ones (LIST,
+// fact, JUNK, ...). Accepts PCM 16/24/32-bit and 32-bit float, plain or
+// WAVE_FORMAT_EXTENSIBLE. The data size is clamped to the file length.
+// read(offset, destination, count) must fill count bytes or return false.
+using ByteSource = std::function<bool(uint64_t offset, void *destination, size_t count)>;
+bool parse_wav(const ByteSource& read, uint64_t fileSize, WavLayout& layout);
+bool parse_wav(std::istream& stream, WavLayout& layout);
+bool parse_wav(std::span<const unsigned char> bytes, WavLayout& layout);
+
+// Header for dataSize bytes of samples. Its size does not depend on
+// dataSize: a JUNK chunk is reserved and becomes ds64, with the file
+// switching to RF64, once the sizes no longer fit in 32 bits.
+std::vector<char> make_wav_header(const WavFormat& format, uint64_t dataSize = 0);
+
+// Sample conversion between interleaved floats in [-1, 1] and the packed
+// little-endian representation of a format; integer output saturates.
+void decode_samples(const unsigned char *bytes, SampleFormat format, std::span<float> out);
+void encode_samples(std::span<const float> in, SampleFormat format, unsigned char *bytes);
+
+#endif //WAV_FORMAT_H
@@ -0,0 +1,106 @@
+#ifndef WAV_STREAM_H
+#define WAV_STREAM_H
+
+#include "async_file.h"
+#include "wav_format.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Streaming counterparts of WavFile: both keep a few buffers of a fixed
+// number of frames, so files of any length run in constant memory. Disk
+// transfers run in the background on the buffers not in use, overlapping
+// with the caller's processing: the reader fetches the next blocks ahead,
+// the writer stores full blocks while the next one is filled.
+
+class WavReader {
+public:
+    explicit WavReader(size_t bufferFrames = 4096,
+                       utils::AsyncFile::Backend backend = utils::AsyncFile::Backend::AUTO);
+    // Waits for the reads still in flight before the buffers go.
+    virtual ~WavReader();
+
+    [[nodiscard]] bool open(const std::string& filename);
+    void close();
+
+    // Fills up to out.size() / channels() frames and returns how many were
+    // read; 0 at the end of the data.
+    size_t read(std::span<float> out);
+    [[nodiscard]] bool seek(size_t frame);
+
+    [[nodiscard]] bool isOpen() const noexcept { return m_file.isOpen(); }
+    [[nodiscard]] const WavFormat& format() const noexcept { return m_format; }
+    [[nodiscard]] unsigned int channels() const noexcept { return m_format.channels; }
+    [[nodiscard]] unsigned int sampleRate() const noexcept { return m_format.sampleRate; }
+    [[nodiscard]] size_t frames() const noexcept { return m_frames; }
+    [[nodiscard]] size_t tell() const noexcept { return m_position; }
+    [[nodiscard]] utils::AsyncFile::Backend backend() const noexcept { return m_file.backend(); }
+
+    // Buffers in rotation: the one being decoded plus reads in flight.
+    static constexpr size_t kQueueDepth{ 3 };
+
+private:
+    bool readAhead();
+    void drain();
+
+    utils::AsyncFile m_file;
+    std::vector<std::vector<unsigned char>> m_buffers;
+    size_t m_bufferFrames{0};
+    WavFormat m_format;
+    uint64_t m_dataOffset{0};
+    size_t m_frames{0};
+    size_t m_position{0};
+
+    size_t m_current{0};
+    size_t m_blockFrames{0};
+    size_t m_blockOffset{0};
+    size_t m_ahead{0};
+};
+
+class WavWriter {
+public:
+    explicit WavWriter(unsigned int sampleRate = 48000, unsigned int channels = 2,
+                       SampleFormat format = SampleFormat::PCM16, size_t bufferFrames = 4096,
+                       utils::AsyncFile::Backend backend = utils::AsyncFile::Backend::AUTO);
+    virtual ~WavWriter();
+
+    // Writes a header with zero sizes; close() patches them, switching to
+    // RF64 if the data outgrew 4 GiB.
+    [[nodiscard]] bool open(const std::string& filename);
+    [[nodiscard]] bool close();
+
+    [[nodiscard]] bool write(std::span<const float> data);
+    // Moves the write position to a frame already written, or to the end.
+    [[nodiscard]] bool seek(size_t frame);
+
+    [[nodiscard]] bool isOpen() const noexcept { return m_file.isOpen(); }
+    [[nodiscard]] const WavFormat& format() const noexcept { return m_format; }
+    [[nodiscard]] unsigned int channels() const noexcept { return m_format.channels; }
+    [[nodiscard]] unsigned int sampleRate() const noexcept { return m_format.sampleRate; }
+    [[nodiscard]] size_t frames() const noexcept { return std::max(m_frames, tell()); }
+    [[nodiscard]] size_t tell() const noexcept { return m_position + m_pending / m_format.channels; }
+    [[nodiscard]] utils::AsyncFile::Backend backend() const noexcept { return m_file.backend(); }
+
+    // Buffers in rotation: the one being filled plus writes in flight.
+    static constexpr size_t kQueueDepth{ 3 };
+
+private:
+    bool flush();
+    bool drain();
+    bool writeNow(uint64_t offset, std::span<const unsigned char> bytes);
+
+    utils::AsyncFile m_file;
+    const WavFormat m_format;
+    std::vector<std::vector<unsigned char>> m_buffers;
+    uint64_t m_dataOffset{0};
+    size_t m_current{0};
+    size_t m_pending{0};
+    size_t m_frames{0};
+    size_t m_position{0};
+    bool m_failed{false};
+};
+
+#endif //WAV_STREAM_H
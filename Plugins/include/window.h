@@ -0,0 +1,26 @@
+#ifndef WINDOW_H
+#define WINDOW_H
+
+#include <cstddef>
+#include <vector>
+
+namespace utils {
+
+enum class WindowType {
+    RECTANGULAR,
+    HANN,
+    HAMMING,
+    BLACKMAN,
+    KAISER,
+};
+
+constexpr float kDefaultKaiserBeta = 8.6f;
+
+// Periodic windows repeat with period `size` and suit overlap-add; symmetric
+// windows are used for filter design. beta only applies to KAISER.
+std::vector<float> make_window(WindowType type, size_t size, bool periodic = true,
+                               float beta = kDefaultKaiserBeta);
+
+} // namespace utils
+
+#endif //WINDOW_H
@@ -0,0 +1,103 @@
+#include "alsa_pcm.h"
+
+namespace {
+
+constexpr unsigned int kDefaultLatencyUs{ 50000 };
+constexpr snd_pcm_uframes_t kDefaultPeriodFrames{ 256 };
+
+// Playback starts once the buffer is full; capture on the first read.
+int configure(snd_pcm_t *handle, const snd_pcm_stream_t stream, PcmConfig& config)
+{
+    snd_pcm_hw_params_t *hw = nullptr;
+    snd_pcm_hw_params_alloca(&hw);
+
+    const snd_pcm_access_t access = config.mmap ? SND_PCM_ACCESS_MMAP_INTERLEAVED : SND_PCM_ACCESS_RW_INTERLEAVED;
+    snd_pcm_uframes_t period = config.periodFrames > 0 ? config.periodFrames : kDefaultPeriodFrames;
+    unsigned int periods = config.periods;
+    unsigned int rate = config.rate;
+
+    int err = 0;
+    const auto failed = [&err](const int result) {
+        err = result;
+        return result < 0;
+    };
+
+    if (failed(snd_pcm_hw_params_any(handle, hw))
+        || failed(snd_pcm_hw_params_set_rate_resample(handle, hw, 0))
+        || failed(snd_pcm_hw_params_set_access(handle, hw, access))
+        || failed(snd_pcm_hw_params_set_format(handle, hw, config.format))
+        || failed(snd_pcm_hw_params_set_channels(handle, hw, config.channels))
+        || failed(snd_pcm_hw_params_set_rate_near(handle, hw, &rate, nullptr))
+        || failed(snd_pcm_hw_params_set_period_size_near(handle, hw, &period, nullptr))
+        || failed(snd_pcm_hw_params_set_periods_near(handle, hw, &periods, nullptr))
+        || failed(snd_pcm_hw_params(handle, hw)))
+        return err;
+
+    snd_pcm_uframes_t buffer = 0;
+    if (failed(snd_pcm_hw_params_get_buffer_size(hw, &buffer)))
+        return err;
+
+    snd_pcm_sw_params_t *sw = nullptr;
+    snd_pcm_sw_params_alloca(&sw);
+
+    const snd_pcm_uframes_t threshold = stream == SND_PCM_STREAM_PLAYBACK ? buffer : 1;
+    if (failed(snd_pcm_sw_params_current(handle, sw))
+        || failed(snd_pcm_sw_params_set_start_threshold(handle, sw, threshold))
+        || failed(snd_pcm_sw_params_set_avail_min(handle, sw, period))
+        || failed(snd_pcm_sw_params(handle, sw)))
+        return err;
+
+    config.rate = rate;
+    config.periods = periods;
+    return 0;
+}
+
+} // namespace
+
+snd_pcm_format_t alsa_format(const SampleFormat format) noexcept
+{
+    switch (format) {
+        case SampleFormat::PCM16:
+            return SND_PCM_FORMAT_S16_LE;
+        case SampleFormat::PCM24:
+            return SND_PCM_FORMAT_S24_3LE;
+        case SampleFormat::PCM32:
+            return SND_PCM_FORMAT_S32_LE;
+        case SampleFormat::FLOAT32:
+            break;
+    }
+    return SND_PCM_FORMAT_FLOAT_LE;
+}
+
+int open_pcm(snd_pcm_t **handle, const std::string& device, const snd_pcm_stream_t stream, PcmConfig& config)
+{
+    int err = snd_pcm_open(handle, device.c_str(), stream, 0);
+    if (err < 0) {
+        *handle = nullptr;
+        return err;
+    }
+
+    if (config.periodFrames > 0 || config.mmap || !config.softResample) {
+        err = configure(*handle, stream, config);
+    } else {
+        err = snd_pcm_set_params(*handle, config.format, SND_PCM_ACCESS_RW_INTERLEAVED,
+                                 config.channels, config.rate, 1, kDefaultLatencyUs);
+    }
+
+    if (err >= 0) {
+        snd_pcm_uframes_t bufferFrames = 0;
+        snd_pcm_uframes_t periodFrames = 0;
+        err = snd_pcm_get_params(*handle, &bufferFrames, &periodFrames);
+        config.bufferFrames = bufferFrames;
+        config.periodFrames = periodFrames;
+    }
+
+    if (err >= 0)
+        err = snd_pcm_prepare(*handle);
+
+    if (err < 0) {
+        snd_pcm_close(*handle);
+        *handle = nullptr;
+    }
+    return err;
+}
@@ -0,0 +1,33 @@
+#ifndef ALSA_PCM_H
+#define ALSA_PCM_H
+
+#include "wav_format.h"
+
+#include <alsa/asoundlib.h>
+#include <string>
+
+// Stream setup shared by AudioPlayer and AudioRecorder.
+
+snd_pcm_format_t alsa_format(SampleFormat format) noexcept;
+
+struct PcmConfig {
+    snd_pcm_format_t format{SND_PCM_FORMAT_FLOAT_LE};
+    unsigned int channels{2};
+    // Requested, then negotiated.
+    unsigned int rate{48000};
+    snd_pcm_uframes_t periodFrames{0};
+    unsigned int periods{2};
+    bool mmap{false};
+    // Let ALSA convert a rate the hardware lacks; false takes the nearest one.
+    bool softResample{true};
+    // Negotiated.
+    snd_pcm_uframes_t bufferFrames{0};
+};
+
+// Opens and prepares a stream. With no period requested, RW access and soft
+// resampling this is snd_pcm_set_params with about 50 ms of buffering;
+// otherwise the hw/sw parameters are set explicitly, without resampling.
+// Returns a negative error code, leaving *handle null, on failure.
+int open_pcm(snd_pcm_t **handle, const std::string& device, snd_pcm_stream_t stream, PcmConfig& config);
+
+#endif //ALSA_PCM_H
@@ -0,0 +1,478 @@
+#include "async_file.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define UTILS_HAVE_IO_URING
+#endif
+
+namespace utils {
+
+class AsyncFile::Engine {
+public:
+    virtual ~Engine() = default;
+
+    virtual bool submit(uint64_t offset, unsigned char *data, size_t size, bool write) = 0;
+    virtual int64_t wait() = 0;
+    [[nodiscard]] virtual size_t pending() const noexcept = 0;
+    [[nodiscard]] virtual Backend backend() const noexcept = 0;
+};
+
+namespace {
+
+// Serves the queue in order with a plain stream on a worker thread.
+class ThreadEngine final : public AsyncFile::Engine {
+public:
+    explicit ThreadEngine(std::fstream stream)
+    : m_stream(std::move(stream))
+    , m_worker(&ThreadEngine::workerLoop, this)
+    {}
+
+    ~ThreadEngine() override
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_one();
+        m_worker.join();
+    }
+
+    bool submit(const uint64_t offset, unsigned char *data, const size_t size, const bool write) override
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_queue.push_back({offset, data, size, write});
+            ++m_pending;
+        }
+        m_wake.notify_one();
+        return true;
+    }
+
+    int64_t wait() override
+    {
+        std::unique_lock lock(m_mutex);
+        if (m_pending == 0)
+            return -1;
+
+        m_done.wait(lock, [this] { return !m_results.empty(); });
+        const int64_t result = m_results.front();
+        m_results.pop_front();
+        --m_pending;
+        return result;
+    }
+
+    [[nodiscard]] size_t pending() const noexcept override
+    {
+        std::lock_guard lock(m_mutex);
+        return m_pending;
+    }
+
+    [[nodiscard]] AsyncFile::Backend backend() const noexcept override { return AsyncFile::Backend::THREAD; }
+
+private:
+    struct Request {
+        uint64_t offset;
+        unsigned char *data;
+        size_t size;
+        bool write;
+    };
+
+    // Queued requests are finished before the worker leaves.
+    void workerLoop()
+    {
+        std::unique_lock lock(m_mutex);
+        while (true) {
+            m_wake.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_queue.empty())
+                return;
+
+            const Request request = m_queue.front();
+            m_queue.pop_front();
+
+            lock.unlock();
+            const int64_t result = transfer(request);
+            lock.lock();
+
+            m_results.push_back(result);
+            m_done.notify_one();
+        }
+    }
+
+    int64_t transfer(const Request& request)
+    {
+        m_stream.clear();
+        const auto offset = static_cast<std::streamoff>(request.offset);
+        const auto size = static_cast<std::streamsize>(request.size);
+
+        if (request.write) {
+            m_stream.seekp(offset);
+            m_stream.write(reinterpret_cast<const char *>(request.data), size);
+            return m_stream ? static_cast<int64_t>(request.size) : -1;
+        }
+
+        m_stream.seekg(offset);
+        m_stream.read(reinterpret_cast<char *>(request.data), size);
+        return m_stream.bad() ? -1 : static_cast<int64_t>(m_stream.gcount());
+    }
+
+    std::fstream m_stream;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    std::deque<Request> m_queue;
+    std::deque<int64_t> m_results;
+    size_t m_pending{0};
+    bool m_stopping{false};
+
+    std::thread m_worker;
+};
+
+#ifdef UTILS_HAVE_IO_URING
+
+// Minimal io_uring driver on the raw system calls, so no liburing is needed.
+// Completions may arrive in any order; they are handed out in submission order.
+class UringEngine final : public AsyncFile::Engine {
+public:
+    explicit UringEngine(const int fd) noexcept
+    : m_fd(fd)
+    {}
+
+    ~UringEngine() override
+    {
+        while (!m_requests.empty()) {
+            wait();
+        }
+
+        if (m_sqes != MAP_FAILED)
+            munmap(m_sqes, m_sqesSize);
+        if (m_cq != MAP_FAILED && m_cq != m_sq)
+            munmap(m_cq, m_cqSize);
+        if (m_sq != MAP_FAILED)
+            munmap(m_sq, m_sqSize);
+        if (m_ring >= 0)
+            ::close(m_ring);
+        ::close(m_fd);
+    }
+
+    UringEngine(const UringEngine&) = delete;
+    UringEngine& operator=(const UringEngine&) = delete;
+
+    // False if the kernel has no io_uring or refuses it (seccomp, sysctl).
+    bool init() noexcept
+    {
+        io_uring_params params{};
+        m_ring = static_cast<int>(syscall(__NR_io_uring_setup, kEntries, &params));
+        if (m_ring < 0)
+            return false;
+
+        m_sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        m_cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single)
+            m_sqSize = m_cqSize = std::max(m_sqSize, m_cqSize);
+
+        m_sq = mmap(nullptr, m_sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQ_RING);
+        if (m_sq == MAP_FAILED)
+            return false;
+
+        m_cq = single ? m_sq
+                      : mmap(nullptr, m_cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring,
+                             IORING_OFF_CQ_RING);
+        if (m_cq == MAP_FAILED)
+            return false;
+
+        m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        m_sqes = mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQES);
+        if (m_sqes == MAP_FAILED)
+            return false;
+
+        auto *sq = static_cast<unsigned char *>(m_sq);
+        auto *cq = static_cast<unsigned char *>(m_cq);
+        m_sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        m_sqMask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        m_sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        m_cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        m_cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        m_cqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+        return true;
+    }
+
+    bool submit(const uint64_t offset, unsigned char *data, const size_t size, const bool write) override
+    {
+        // Bound the requests inside the kernel by the completion ring.
+        while (m_inFlight >= kEntries) {
+            reap();
+        }
+
+        const uint64_t id = m_nextId++;
+        Request& request = m_requests[id];
+        request.vector = {data, size};
+        request.offset = offset;
+        request.write = write;
+
+        const unsigned tail = *m_sqTail;
+        const unsigned index = tail & m_sqMask;
+        auto *sqe = static_cast<io_uring_sqe *>(m_sqes) + index;
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = write ? IORING_OP_WRITEV : IORING_OP_READV;
+        sqe->fd = m_fd;
+        sqe->off = offset;
+        sqe->addr = reinterpret_cast<uint64_t>(&request.vector);
+        sqe->len = 1;
+        sqe->user_data = id;
+        m_sqArray[index] = index;
+        __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+
+        // The entry is already published and the kernel may still take it
+        // later, so there is no backing out: keep trying, or give up hard.
+        while (enter(1, 0, 0) < 0) {
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                fail("submission");
+            if (m_inFlight > 0)
+                reap();
+        }
+
+        ++m_inFlight;
+        return true;
+    }
+
+    int64_t wait() override
+    {
+        const auto it = m_requests.find(m_oldestId);
+        if (it == m_requests.end())
+            return -1;
+
+        while (!it->second.done) {
+            reap();
+        }
+
+        const int64_t result = finish(it->second);
+        m_requests.erase(it);
+        ++m_oldestId;
+        return result;
+    }
+
+    [[nodiscard]] size_t pending() const noexcept override { return m_requests.size(); }
+
+    [[nodiscard]] AsyncFile::Backend backend() const noexcept override { return AsyncFile::Backend::IO_URING; }
+
+private:
+    static constexpr unsigned kEntries{ 8 };
+
+    struct Request {
+        iovec vector{};
+        uint64_t offset{0};
+        int64_t result{0};
+        bool write{false};
+        bool done{false};
+    };
+
+    long enter(const unsigned submit, const unsigned complete, const unsigned flags) const noexcept
+    {
+        return syscall(__NR_io_uring_enter, m_ring, submit, complete, flags, nullptr, 0);
+    }
+
+    // The kernel may still be writing into buffers the caller owns, so
+    // neither faking a completion nor tearing the ring down is safe.
+    [[noreturn]] static void fail(const char *what)
+    {
+        std::cerr << "io_uring " << what << " failed: " << std::strerror(errno) << std::endl;
+        std::abort();
+    }
+
+    // Blocks for at least one completion and records all that are ready.
+    void reap()
+    {
+        unsigned head = *m_cqHead;
+        while (head == __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE)) {
+            if (enter(0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                fail("wait");
+        }
+
+        for (; head != __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE); ++head) {
+            const io_uring_cqe& cqe = m_cqes[head & m_cqMask];
+            if (const auto it = m_requests.find(cqe.user_data); it != m_requests.end()) {
+                it->second.result = cqe.res;
+                it->second.done = true;
+            }
+            --m_inFlight;
+        }
+        __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+    }
+
+    // Short transfers are legal for io_uring; complete them synchronously.
+    int64_t finish(const Request& request) const noexcept
+    {
+        if (request.result < 0)
+            return -1;
+
+        auto *data = static_cast<unsigned char *>(request.vector.iov_base);
+        const size_t size = request.vector.iov_len;
+        auto done = static_cast<size_t>(request.result);
+        while (done < size) {
+            const auto offset = static_cast<off_t>(request.offset + done);
+            const ssize_t moved = request.write ? pwrite(m_fd, data + done, size - done, offset)
+                                                : pread(m_fd, data + done, size - done, offset);
+            if (moved < 0 && errno == EINTR)
+                continue;
+            if (moved < 0 || (moved == 0 && request.write))
+                return -1;
+            if (moved == 0)
+                break;
+            done += static_cast<size_t>(moved);
+        }
+
+        return static_cast<int64_t>(done);
+    }
+
+    int m_fd;
+    int m_ring{-1};
+
+    void *m_sq{MAP_FAILED};
+    void *m_cq{MAP_FAILED};
+    void *m_sqes{MAP_FAILED};
+    size_t m_sqSize{0};
+    size_t m_cqSize{0};
+    size_t m_sqesSize{0};
+
+    unsigned *m_sqTail{nullptr};
+    unsigned *m_sqArray{nullptr};
+    unsigned m_sqMask{0};
+    unsigned *m_cqHead{nullptr};
+    unsigned *m_cqTail{nullptr};
+    unsigned m_cqMask{0};
+    io_uring_cqe *m_cqes{nullptr};
+
+    std::map<uint64_t, Request> m_requests;
+    uint64_t m_nextId{0};
+    uint64_t m_oldestId{0};
+    unsigned m_inFlight{0};
+};
+
+std::unique_ptr<AsyncFile::Engine> open_uring(const std::string& filename, const AsyncFile::Mode mode,
+                                              uint64_t& size, bool& failed)
+{
+    const int flags = mode == AsyncFile::Mode::READ ? O_RDONLY : O_WRONLY | O_CREAT | O_TRUNC;
+    const int fd = ::open(filename.c_str(), flags | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        failed = true;
+        return nullptr;
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        failed = true;
+        return nullptr;
+    }
+
+    auto engine = std::make_unique<UringEngine>(fd);
+    if (!engine->init())
+        return nullptr;
+
+    size = static_cast<uint64_t>(info.st_size);
+    return engine;
+}
+
+#endif
+
+std::unique_ptr<AsyncFile::Engine> open_thread(const std::string& filename, const AsyncFile::Mode mode,
+                                               uint64_t& size)
+{
+    const auto flags = mode == AsyncFile::Mode::READ ? std::ios::in | std::ios::binary
+                                                     : std::ios::out | std::ios::binary | std::ios::trunc;
+    std::fstream stream(filename, flags);
+    if (!stream.is_open())
+        return nullptr;
+
+    std::error_code error;
+    const auto length = std::filesystem::file_size(filename, error);
+    size = error ? 0 : static_cast<uint64_t>(length);
+
+    return std::make_unique<ThreadEngine>(std::move(stream));
+}
+
+} // namespace
+
+AsyncFile::AsyncFile(const Backend backend) noexcept
+: m_requested(backend)
+{}
+
+AsyncFile::~AsyncFile() = default;
+
+bool AsyncFile::open(const std::string& filename, const Mode mode)
+{
+    close();
+
+#ifdef UTILS_HAVE_IO_URING
+    if (m_requested != Backend::THREAD) {
+        bool failed = false;
+        m_engine = open_uring(filename, mode, m_size, failed);
+        if (failed)
+            return false;
+    }
+#endif
+
+    if (!m_engine)
+        m_engine = open_thread(filename, mode, m_size);
+
+    return isOpen();
+}
+
+void AsyncFile::close()
+{
+    m_engine.reset();
+    m_size = 0;
+}
+
+bool AsyncFile::read(const uint64_t offset, std::span<unsigned char> buffer)
+{
+    return isOpen() && m_engine->submit(offset, buffer.data(), buffer.size(), false);
+}
+
+bool AsyncFile::write(const uint64_t offset, std::span<const unsigned char> buffer)
+{
+    return isOpen() && m_engine->submit(offset, const_cast<unsigned char *>(buffer.data()), buffer.size(), true);
+}
+
+int64_t AsyncFile::wait()
+{
+    return isOpen() ? m_engine->wait() : -1;
+}
+
+size_t AsyncFile::pending() const noexcept
+{
+    return isOpen() ? m_engine->pending() : 0;
+}
+
+AsyncFile::Backend AsyncFile::backend() const noexcept
+{
+    return isOpen() ? m_engine->backend() : Backend::AUTO;
+}
+
+} // namespace utils
@@ -0,0 +1,273 @@
+#include "audio_engine.h"
+
+#include <algorithm>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+constexpr int kRealtimePriority{ 80 };
+
+// Usually needs CAP_SYS_NICE or an rtprio limit; without it the thread
+// keeps normal scheduling.
+bool raise_priority() noexcept
+{
+#if defined(__unix__) || defined(__APPLE__)
+    sched_param param{};
+    param.sched_priority = std::min(kRealtimePriority, sched_get_priority_max(SCHED_FIFO));
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+WavSink::WavSink(const unsigned int sampleRate, const unsigned int channels, const SampleFormat format,
+                 const bool paced)
+: m_writer(sampleRate, channels, format)
+, m_paced(paced)
+{}
+
+bool WavSink::open(const std::string& filename)
+{
+    m_frames = 0;
+    m_counters.reset();
+    return m_writer.open(filename);
+}
+
+bool WavSink::close()
+{
+    return m_writer.close();
+}
+
+bool WavSink::write(std::span<const float> frames)
+{
+    const auto begin = std::chrono::steady_clock::now();
+    if (m_paced) {
+        if (m_frames == 0)
+            m_start = std::chrono::steady_clock::now();
+
+        const auto due = std::chrono::duration<double>(static_cast<double>(m_frames) / sampleRate());
+        std::this_thread::sleep_until(m_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(due));
+    }
+
+    const size_t count = frames.size() / channels();
+    m_frames += count;
+    const bool written = m_writer.write(frames);
+    m_counters.recordWrite(count, std::chrono::steady_clock::now() - begin);
+    return written;
+}
+
+PlaybackStats WavSink::stats() const noexcept
+{
+    PlaybackStats stats;
+    stats.sampleRate = sampleRate();
+    m_counters.collect(stats);
+    return stats;
+}
+
+WavSource::WavSource(const bool paced)
+: m_paced(paced)
+{}
+
+bool WavSource::open(const std::string& filename)
+{
+    m_frames = 0;
+    m_finished.store(false, std::memory_order_release);
+    return m_reader.open(filename);
+}
+
+void WavSource::close()
+{
+    m_reader.close();
+}
+
+bool WavSource::read(std::span<float> frames)
+{
+    if (m_paced) {
+        if (m_frames == 0)
+            m_start = std::chrono::steady_clock::now();
+
+        // A capture device hands over a period once it has been recorded.
+        const uint64_t end = m_frames + frames.size() / channels();
+        const auto due = std::chrono::duration<double>(static_cast<double>(end) / sampleRate());
+        std::this_thread::sleep_until(m_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(due));
+    }
+
+    size_t filled = 0;
+    while (filled < frames.size()) {
+        const size_t count = m_reader.read(frames.subspan(filled));
+        if (count == 0)
+            break;
+        filled += count * channels();
+    }
+
+    if (filled < frames.size()) {
+        std::fill(frames.begin() + static_cast<std::ptrdiff_t>(filled), frames.end(), 0.f);
+        m_finished.store(true, std::memory_order_release);
+    }
+
+    m_frames += frames.size() / channels();
+    return true;
+}
+
+AudioEngine::AudioEngine(const unsigned int channels, const size_t periodFrames, const size_t ringFrames)
+: m_channels(std::max(channels, 1u))
+, m_periodFrames(std::max<size_t>(periodFrames, 1))
+, m_ring(std::max(ringFrames, m_periodFrames) * m_channels)
+, m_period(m_periodFrames * m_channels)
+{}
+
+AudioEngine::~AudioEngine()
+{
+    stop();
+}
+
+void AudioEngine::setCallback(Callback callback)
+{
+    if (!isRunning())
+        m_callback = std::move(callback);
+}
+
+bool AudioEngine::start(AudioSink& sink)
+{
+    return launch(nullptr, sink);
+}
+
+bool AudioEngine::start(AudioSource& source, AudioSink& sink)
+{
+    if (source.channels() != m_channels) {
+        std::cerr << "Audio source has " << source.channels() << " channels, engine " << m_channels << std::endl;
+        return false;
+    }
+
+    if (source.sampleRate() != sink.sampleRate()) {
+        std::cerr << "Audio source runs at " << source.sampleRate() << " Hz, sink at " << sink.sampleRate()
+                  << " Hz" << std::endl;
+        return false;
+    }
+
+    return launch(&source, sink);
+}
+
+bool AudioEngine::launch(AudioSource *source, AudioSink& sink)
+{
+    if (isRunning())
+        return false;
+
+    if (sink.channels() != m_channels) {
+        std::cerr << "Audio sink has " << sink.channels() << " channels, engine " << m_channels << std::endl;
+        return false;
+    }
+
+    if (m_thread.joinable())
+        m_thread.join();
+
+    m_failed.store(false, std::memory_order_relaxed);
+    // Frames queued ahead of this start() count as feeding it.
+    m_fed.store(m_ring.readable() > 0, std::memory_order_relaxed);
+    m_frames.store(0, std::memory_order_relaxed);
+    m_underruns.store(0, std::memory_order_relaxed);
+    m_captureXruns.store(0, std::memory_order_relaxed);
+    m_playbackXruns.store(0, std::memory_order_relaxed);
+    m_roundTrip.store(0, std::memory_order_relaxed);
+    m_maxRoundTrip.store(0, std::memory_order_relaxed);
+    m_callbackTimes.reset();
+    m_running.store(true, std::memory_order_release);
+    m_thread = std::thread(&AudioEngine::run, this, source, std::ref(sink));
+
+    return true;
+}
+
+void AudioEngine::stop()
+{
+    m_running.store(false, std::memory_order_release);
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+size_t AudioEngine::push(std::span<const float> frames) noexcept
+{
+    m_fed.store(true, std::memory_order_relaxed);
+
+    const size_t count = std::min(frames.size() / m_channels, writableFrames());
+    return m_ring.write(frames.first(count * m_channels)) / m_channels;
+}
+
+// Fills the playback buffer with silence. A device that starts on a full
+// buffer then starts here, together with any capture stream linked to it.
+bool AudioEngine::prime(AudioSink& sink)
+{
+    std::fill(m_period.begin(), m_period.end(), 0.f);
+
+    for (size_t frames = sink.bufferFrames(); frames > 0;) {
+        const size_t count = std::min(frames, m_periodFrames);
+        if (!sink.write(std::span<const float>(m_period).first(count * m_channels)))
+            return false;
+        frames -= count;
+    }
+    return true;
+}
+
+PlaybackStats AudioEngine::stats(const AudioSink& sink) const noexcept
+{
+    PlaybackStats stats = sink.stats();
+    stats.underruns = underruns();
+    stats.captureXruns = captureXruns();
+    stats.callback = m_callbackTimes.snapshot();
+    return stats;
+}
+
+void AudioEngine::run(AudioSource *source, AudioSink& sink)
+{
+    m_realtime.store(raise_priority(), std::memory_order_release);
+
+    if (source && !prime(sink)) {
+        m_failed.store(true, std::memory_order_release);
+        m_running.store(false, std::memory_order_release);
+        return;
+    }
+
+    while (m_running.load(std::memory_order_acquire)) {
+        int64_t captureDelay = 0;
+        if (source) {
+            captureDelay = source->delayFrames();
+            if (!source->read(m_period)) {
+                m_failed.store(true, std::memory_order_release);
+                break;
+            }
+        } else if (const size_t available = m_ring.read(m_period); available < m_period.size()) {
+            std::fill(m_period.begin() + static_cast<std::ptrdiff_t>(available), m_period.end(), 0.f);
+            if (m_fed.load(std::memory_order_relaxed))
+                m_underruns.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (m_callback) {
+            const auto begin = std::chrono::steady_clock::now();
+            m_callback(m_period);
+            m_callbackTimes.record(std::chrono::steady_clock::now() - begin);
+        }
+
+        if (!sink.write(m_period)) {
+            m_failed.store(true, std::memory_order_release);
+            break;
+        }
+        m_frames.fetch_add(m_periodFrames, std::memory_order_relaxed);
+
+        if (source) {
+            const int64_t roundTrip = captureDelay + sink.delayFrames();
+            m_roundTrip.store(roundTrip, std::memory_order_relaxed);
+            if (roundTrip > m_maxRoundTrip.load(std::memory_order_relaxed))
+                m_maxRoundTrip.store(roundTrip, std::memory_order_relaxed);
+            m_captureXruns.store(source->xruns(), std::memory_order_relaxed);
+            m_playbackXruns.store(sink.xruns(), std::memory_order_relaxed);
+        }
+    }
+
+    m_running.store(false, std::memory_order_release);
+}
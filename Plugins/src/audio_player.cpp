@@ -1,9 +1,12 @@
 #include "../include/audio_player.h"
+#include "alsa_pcm.h"
 
+#include <algorithm>
 #include <iostream>
 
-AudioPlayer::AudioPlayer(unsigned int rate, unsigned int channels) noexcept
-: m_channels(channels), m_rate(rate)
+AudioPlayer::AudioPlayer(unsigned int rate, unsigned int channels, SampleFormat format) noexcept
+: m_sampleFormat(format), m_format(alsa_format(format)), m_channels(channels), m_rate(rate), m_deviceRate(rate)
+, m_ditherer(channels, 8 * bytes_per_sample(format), DitherType::NONE)
 {}
 
 AudioPlayer::~AudioPlayer()
@@ -17,26 +20,69 @@ void AudioPlayer::setDevice(const std::string& device)
     m_device = device;
 }
 
+void AudioPlayer::setDither(DitherType type)
+{
+    m_ditherer = Ditherer(m_channels, 8 * bytes_per_sample(m_sampleFormat), type);
+}
+
+void AudioPlayer::setPeriod(const size_t periodFrames, const unsigned int periods)
+{
+    m_requestedPeriod = periodFrames;
+    m_requestedPeriods = std::max(periods, 2u);
+}
+
+void AudioPlayer::setMmap(const bool enabled)
+{
+    m_mmap = enabled;
+}
+
+void AudioPlayer::setResampling(const bool enabled, const filter::ResampleQuality quality)
+{
+    m_resampling = enabled;
+    m_quality = quality;
+}
+
+std::chrono::microseconds AudioPlayer::latency() const noexcept
+{
+    if (m_deviceRate == 0)
+        return {};
+    return std::chrono::microseconds(m_bufferFrames * 1000000 / m_deviceRate);
+}
+
 bool AudioPlayer::start()
 {
     if (m_isPlaying)
         return false;
 
-    int err = snd_pcm_open (&m_handle, m_device.c_str(),
-                           SND_PCM_STREAM_PLAYBACK, 0);
-    if (err < 0) {
-        std::cerr << "cannot open audio device " << m_device << snd_strerror(err);
+    PcmConfig config{m_format, m_channels, m_rate, m_requestedPeriod, m_requestedPeriods, m_mmap, !m_resampling};
+    if (const int err = open_pcm(&m_handle, m_device, SND_PCM_STREAM_PLAYBACK, config); err < 0) {
+        std::cerr << "Playback open error on " << m_device << ": " << snd_strerror(err) << std::endl;
         return false;
     }
 
-    err = snd_pcm_set_params(m_handle, m_format, SND_PCM_ACCESS_RW_INTERLEAVED,
-                             m_channels, m_rate, 1, 50000);
-    if (err < 0) {
-        std::cerr << "Playback open error: " << snd_strerror(err);
-        return false;
+    // sampleRate() stays what the caller asked for; if the device settled
+    // on another rate, write() converts to it.
+    m_deviceRate = config.rate;
+    if (m_deviceRate != m_rate) {
+        m_resampler.emplace(m_rate, m_deviceRate, m_channels, m_quality);
+    } else {
+        m_resampler.reset();
+    }
+
+    m_periodFrames = config.periodFrames;
+    m_bufferFrames = config.bufferFrames;
+
+    // Sized here so write() never allocates once an AudioEngine drives it;
+    // the resampler is fed at most one period at a time.
+    size_t deviceFrames = std::max<size_t>(m_periodFrames, 1);
+    if (m_resampler) {
+        m_resampled.resize(m_resampler->maxOutputFrames(deviceFrames) * m_channels);
+        deviceFrames = m_resampled.size() / m_channels;
     }
+    m_scratch.reserve(deviceFrames * m_channels);
+    m_buffer.reserve(deviceFrames * m_channels * bytes_per_sample(m_sampleFormat));
 
-    snd_pcm_prepare(m_handle);
+    m_counters.reset();
     m_isPlaying = true;
 
     return true;
@@ -48,19 +94,153 @@ bool AudioPlayer::stop()
         return false;
 
     snd_pcm_close(m_handle);
+    m_handle = nullptr;
     m_isPlaying = false;
 
     return true;
 }
 
-void AudioPlayer::playSound(const std::span<float> &data) const
+void AudioPlayer::playSound(const std::span<float> &data)
+{
+    if (!write(data))
+        std::cerr << "Failed to play sound." << std::endl;
+}
+
+bool AudioPlayer::write(std::span<const float> frames)
+{
+    if (!m_isPlaying)
+        return false;
+
+    if (!m_resampler)
+        return writeDevice(frames);
+
+    const size_t chunk = std::max<size_t>(m_periodFrames, 1) * m_channels;
+    for (size_t offset = 0; offset < frames.size(); offset += chunk) {
+        const auto input = frames.subspan(offset, std::min(chunk, frames.size() - offset));
+        const size_t count = m_resampler->process(input, m_resampled);
+        if (!writeDevice(std::span<const float>(m_resampled).first(count * m_channels)))
+            return false;
+    }
+    return true;
+}
+
+bool AudioPlayer::writeDevice(std::span<const float> samples)
 {
-    if (const snd_pcm_sframes_t err = snd_pcm_writei(m_handle, data.data(), data.size() / m_channels); err < 0) {
-        if (err == -EPIPE) {
-            perror("Buffer overfill");
-            snd_pcm_prepare(m_handle);
-        } else {
-            perror("write to audio interface failed");
+    if (m_sampleFormat != SampleFormat::FLOAT32 && m_ditherer.type() != DitherType::NONE) {
+        m_scratch.assign(samples.begin(), samples.end());
+        m_ditherer.process(m_scratch);
+        samples = m_scratch;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    const bool written = m_mmap ? writeMmap(samples) : writeFrames(samples);
+    m_counters.recordWrite(written ? samples.size() / m_channels : 0, std::chrono::steady_clock::now() - begin);
+
+    if (snd_pcm_sframes_t delay = 0; snd_pcm_delay(m_handle, &delay) >= 0)
+        m_counters.setDelay(std::max<snd_pcm_sframes_t>(delay, 0));
+
+    return written;
+}
+
+bool AudioPlayer::writeFrames(std::span<const float> samples)
+{
+    const auto *bytes = reinterpret_cast<const unsigned char *>(samples.data());
+    if (m_sampleFormat != SampleFormat::FLOAT32) {
+        m_buffer.resize(samples.size() * bytes_per_sample(m_sampleFormat));
+        encode_samples(samples, m_sampleFormat, m_buffer.data());
+        bytes = m_buffer.data();
+    }
+
+    const size_t frameBytes = m_channels * bytes_per_sample(m_sampleFormat);
+    auto remaining = static_cast<snd_pcm_uframes_t>(samples.size() / m_channels);
+    while (remaining > 0) {
+        const snd_pcm_sframes_t written = snd_pcm_writei(m_handle, bytes, remaining);
+        if (written < 0) {
+            if (!recover(static_cast<int>(written)))
+                return false;
+            continue;
         }
+
+        bytes += static_cast<size_t>(written) * frameBytes;
+        remaining -= static_cast<snd_pcm_uframes_t>(written);
     }
+
+    return true;
+}
+
+// Samples are converted directly into the mapped device buffer.
+bool AudioPlayer::writeMmap(std::span<const float> samples)
+{
+    while (!samples.empty()) {
+        const snd_pcm_sframes_t available = snd_pcm_avail_update(m_handle);
+        if (available < 0) {
+            if (!recover(static_cast<int>(available)))
+                return false;
+            continue;
+        }
+
+        if (available == 0) {
+            // A full buffer that has not started yet never drains by itself.
+            if (snd_pcm_state(m_handle) == SND_PCM_STATE_PREPARED) {
+                if (const int err = snd_pcm_start(m_handle); err < 0 && !recover(err))
+                    return false;
+            } else if (const int err = snd_pcm_wait(m_handle, -1); err < 0 && !recover(err)) {
+                return false;
+            }
+            continue;
+        }
+
+        const snd_pcm_channel_area_t *areas = nullptr;
+        snd_pcm_uframes_t offset = 0;
+        auto count = std::min(static_cast<snd_pcm_uframes_t>(available),
+                              static_cast<snd_pcm_uframes_t>(samples.size() / m_channels));
+        if (const int err = snd_pcm_mmap_begin(m_handle, &areas, &offset, &count); err < 0) {
+            if (!recover(err))
+                return false;
+            continue;
+        }
+
+        const snd_pcm_channel_area_t& area = areas[0];
+        auto *destination = static_cast<unsigned char *>(area.addr) + area.first / 8 + offset * (area.step / 8);
+        encode_samples(samples.first(count * m_channels), m_sampleFormat, destination);
+
+        const snd_pcm_sframes_t committed = snd_pcm_mmap_commit(m_handle, offset, count);
+        if (committed < 0 || static_cast<snd_pcm_uframes_t>(committed) != count) {
+            if (!recover(committed < 0 ? static_cast<int>(committed) : -EPIPE))
+                return false;
+            continue;
+        }
+
+        samples = samples.subspan(count * m_channels);
+    }
+
+    return true;
+}
+
+int64_t AudioPlayer::delayFrames() const noexcept
+{
+    return m_counters.delay() * m_rate / std::max(m_deviceRate, 1u);
+}
+
+PlaybackStats AudioPlayer::stats() const noexcept
+{
+    PlaybackStats stats;
+    stats.sampleRate = m_deviceRate;
+    stats.periodFrames = m_periodFrames;
+    stats.bufferFrames = m_bufferFrames;
+    m_counters.collect(stats);
+    return stats;
+}
+
+// Underruns (-EPIPE) and suspends (-ESTRPIPE) restart the stream.
+bool AudioPlayer::recover(const int err)
+{
+    if (err == -EPIPE)
+        m_counters.recordXrun();
+
+    if (const int result = snd_pcm_recover(m_handle, err, 1); result < 0) {
+        std::cerr << "Write to audio interface failed: " << snd_strerror(result) << std::endl;
+        return false;
+    }
+    return true;
 }
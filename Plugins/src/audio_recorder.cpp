@@ -0,0 +1,146 @@
+#include "../include/audio_recorder.h"
+#include "alsa_pcm.h"
+
+#include <algorithm>
+#include <iostream>
+
+AudioRecorder::AudioRecorder(unsigned int rate, unsigned int channels, SampleFormat format) noexcept
+: m_sampleFormat(format), m_format(alsa_format(format)), m_channels(channels), m_rate(rate)
+{}
+
+AudioRecorder::~AudioRecorder()
+{
+    if (m_isRecording && !stop())
+        std::cerr << "Failed to stop audio recorder." << std::endl;
+}
+
+void AudioRecorder::setDevice(const std::string& device)
+{
+    m_device = device;
+}
+
+void AudioRecorder::setPeriod(const size_t periodFrames, const unsigned int periods)
+{
+    m_requestedPeriod = std::max<size_t>(periodFrames, 1);
+    m_requestedPeriods = std::max(periods, 2u);
+}
+
+std::chrono::microseconds AudioRecorder::latency() const noexcept
+{
+    if (m_rate == 0)
+        return {};
+    return std::chrono::microseconds(m_bufferFrames * 1000000 / m_rate);
+}
+
+bool AudioRecorder::start()
+{
+    if (m_isRecording)
+        return false;
+
+    PcmConfig config{m_format, m_channels, m_rate, m_requestedPeriod, m_requestedPeriods, false};
+    if (const int err = open_pcm(&m_handle, m_device, SND_PCM_STREAM_CAPTURE, config); err < 0) {
+        std::cerr << "Capture open error on " << m_device << ": " << snd_strerror(err) << std::endl;
+        return false;
+    }
+
+    m_rate = config.rate;
+    m_periodFrames = config.periodFrames;
+    m_bufferFrames = config.bufferFrames;
+
+    // Sized here so read() never allocates on the engine thread; integer
+    // formats are captured one period at a time.
+    if (m_sampleFormat != SampleFormat::FLOAT32)
+        m_buffer.resize(std::max<size_t>(m_periodFrames, 1) * m_channels * bytes_per_sample(m_sampleFormat));
+    m_xruns.store(0, std::memory_order_relaxed);
+    m_isRecording = true;
+
+    return true;
+}
+
+bool AudioRecorder::stop()
+{
+    if (!m_isRecording)
+        return false;
+
+    if (m_linked)
+        snd_pcm_unlink(m_handle);
+    snd_pcm_close(m_handle);
+    m_handle = nullptr;
+    m_isRecording = false;
+    m_linked = false;
+
+    return true;
+}
+
+bool AudioRecorder::link(AudioPlayer& player)
+{
+    if (!m_isRecording || player.handle() == nullptr)
+        return false;
+
+    if (const int err = snd_pcm_link(m_handle, player.handle()); err < 0) {
+        std::cerr << "Cannot link capture to playback: " << snd_strerror(err) << std::endl;
+        return false;
+    }
+
+    m_linked = true;
+    return true;
+}
+
+bool AudioRecorder::read(std::span<float> frames)
+{
+    if (!m_isRecording)
+        return false;
+
+    if (m_sampleFormat == SampleFormat::FLOAT32)
+        return readFrames(reinterpret_cast<unsigned char *>(frames.data()), frames.size() / m_channels);
+
+    const size_t chunk = m_buffer.size() / bytes_per_sample(m_sampleFormat);
+    for (size_t offset = 0; offset < frames.size(); offset += chunk) {
+        const auto part = frames.subspan(offset, std::min(chunk, frames.size() - offset));
+        if (!readFrames(m_buffer.data(), part.size() / m_channels))
+            return false;
+        decode_samples(m_buffer.data(), m_sampleFormat, part);
+    }
+
+    return true;
+}
+
+bool AudioRecorder::readFrames(unsigned char *bytes, const size_t frames)
+{
+    const size_t frameBytes = m_channels * bytes_per_sample(m_sampleFormat);
+    auto remaining = static_cast<snd_pcm_uframes_t>(frames);
+    while (remaining > 0) {
+        const snd_pcm_sframes_t captured = snd_pcm_readi(m_handle, bytes, remaining);
+        if (captured < 0) {
+            if (!recover(static_cast<int>(captured)))
+                return false;
+            continue;
+        }
+
+        bytes += static_cast<size_t>(captured) * frameBytes;
+        remaining -= static_cast<snd_pcm_uframes_t>(captured);
+    }
+
+    return true;
+}
+
+int64_t AudioRecorder::delayFrames() const noexcept
+{
+    snd_pcm_sframes_t delay = 0;
+    if (!m_isRecording || snd_pcm_delay(m_handle, &delay) < 0)
+        return 0;
+    return std::max<int64_t>(delay, 0);
+}
+
+// Overruns (-EPIPE) and suspends (-ESTRPIPE) restart the stream.
+bool AudioRecorder::recover(const int err)
+{
+    if (err == -EPIPE)
+        m_xruns.fetch_add(1, std::memory_order_relaxed);
+
+    if (const int result = snd_pcm_recover(m_handle, err, 1); result < 0) {
+        std::cerr << "Read from audio interface failed: " << snd_strerror(result) << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,216 @@
+#include "biquad.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <numbers>
+
+namespace filter {
+
+namespace {
+
+using zcomplex = std::complex<double>;
+
+Biquad normalized(const double b0, const double b1, const double b2,
+                  const double a0, const double a1, const double a2)
+{
+    return {static_cast<float>(b0 / a0), static_cast<float>(b1 / a0), static_cast<float>(b2 / a0),
+            static_cast<float>(a1 / a0), static_cast<float>(a2 / a0)};
+}
+
+// Maps analog low-pass prototype poles (cutoff 1 rad/s) to a digital
+// band-pass: s -> (s^2 + w0^2) / (bw s), then the bilinear transform with
+// prewarped edges. Every section has zeros at z = 1 and z = -1 and unit gain
+// at the band centre; `gain` scales the first one.
+std::vector<Biquad> bandpass_from_prototype(const std::vector<zcomplex>& prototype, const double gain,
+                                            const float sampleRate, const float lowerBound, const float upperBound)
+{
+    const double fs = sampleRate;
+    const double nyquist = 0.499 * fs;
+    const double low = std::clamp<double>(lowerBound, 1e-3, nyquist);
+    const double high = std::clamp<double>(upperBound, low * 1.0001, nyquist);
+
+    const double lowEdge = 2.0 * fs * std::tan(std::numbers::pi * low / fs);
+    const double highEdge = 2.0 * fs * std::tan(std::numbers::pi * high / fs);
+    const double center = std::sqrt(lowEdge * highEdge);
+    const double bandwidth = highEdge - lowEdge;
+
+    const auto bilinear = [fs](const zcomplex s) {
+        return (2.0 * fs + s) / (2.0 * fs - s);
+    };
+
+    const double omega = 2.0 * std::atan(center / (2.0 * fs));
+    const zcomplex z1 = std::polar(1.0, -omega);
+    const zcomplex z2 = z1 * z1;
+
+    std::vector<Biquad> sections;
+    for (const auto& pole : prototype) {
+        // Conjugate prototype poles map to the conjugate sections.
+        if (pole.imag() < 0.0)
+            continue;
+
+        const zcomplex scaled = pole * bandwidth / 2.0;
+        const zcomplex root = std::sqrt(scaled * scaled - center * center);
+        const zcomplex first = bilinear(scaled + root);
+        const zcomplex second = bilinear(scaled - root);
+
+        // A real prototype pole gives one section with both poles, a
+        // complex one gives two sections with a conjugate pair each.
+        std::vector<std::pair<zcomplex, zcomplex>> pairs;
+        if (pole.imag() == 0.0) {
+            pairs.emplace_back(first, second);
+        } else {
+            pairs.emplace_back(first, std::conj(first));
+            pairs.emplace_back(second, std::conj(second));
+        }
+
+        for (const auto& [p, q] : pairs) {
+            const double a1 = -(p + q).real();
+            const double a2 = (p * q).real();
+            const double response = std::abs((1.0 - z2) / (1.0 + a1 * z1 + a2 * z2));
+            const double b = response > 0.0 ? 1.0 / response : 1.0;
+            sections.push_back(normalized(b, 0.0, -b, 1.0, a1, a2));
+        }
+    }
+
+    if (!sections.empty()) {
+        sections.front().b0 *= static_cast<float>(gain);
+        sections.front().b2 *= static_cast<float>(gain);
+    }
+
+    return sections;
+}
+
+} // namespace
+
+Biquad design_biquad(const BiquadType type, const float sampleRate, const float frequency, const float q, const float gainDb)
+{
+    const double w0 = 2.0 * std::numbers::pi * std::clamp<double>(frequency, 0.0, sampleRate / 2.0) / sampleRate;
+    const double cosw = std::cos(w0);
+    const double alpha = std::sin(w0) / (2.0 * std::max(q, 1e-6f));
+    const double A = std::pow(10.0, gainDb / 40.0);
+    const double shelf = 2.0 * std::sqrt(A) * alpha;
+
+    switch (type) {
+        case BiquadType::LOWPASS:
+            return normalized((1 - cosw) / 2, 1 - cosw, (1 - cosw) / 2, 1 + alpha, -2 * cosw, 1 - alpha);
+        case BiquadType::HIGHPASS:
+            return normalized((1 + cosw) / 2, -(1 + cosw), (1 + cosw) / 2, 1 + alpha, -2 * cosw, 1 - alpha);
+        case BiquadType::BANDPASS:
+            return normalized(alpha, 0, -alpha, 1 + alpha, -2 * cosw, 1 - alpha);
+        case BiquadType::NOTCH:
+            return normalized(1, -2 * cosw, 1, 1 + alpha, -2 * cosw, 1 - alpha);
+        case BiquadType::ALLPASS:
+            return normalized(1 - alpha, -2 * cosw, 1 + alpha, 1 + alpha, -2 * cosw, 1 - alpha);
+        case BiquadType::PEAK:
+            return normalized(1 + alpha * A, -2 * cosw, 1 - alpha * A, 1 + alpha / A, -2 * cosw, 1 - alpha / A);
+        case BiquadType::LOWSHELF:
+            return normalized(A * ((A + 1) - (A - 1) * cosw + shelf), 2 * A * ((A - 1) - (A + 1) * cosw),
+                              A * ((A + 1) - (A - 1) * cosw - shelf), (A + 1) + (A - 1) * cosw + shelf,
+                              -2 * ((A - 1) + (A + 1) * cosw), (A + 1) + (A - 1) * cosw - shelf);
+        case BiquadType::HIGHSHELF:
+            return normalized(A * ((A + 1) + (A - 1) * cosw + shelf), -2 * A * ((A - 1) + (A + 1) * cosw),
+                              A * ((A + 1) + (A - 1) * cosw - shelf), (A + 1) - (A - 1) * cosw + shelf,
+                              2 * ((A - 1) - (A + 1) * cosw), (A + 1) - (A - 1) * cosw - shelf);
+    }
+
+    return {};
+}
+
+std::vector<Biquad> butterworth_bandpass(size_t order, const float sampleRate, const float lowerBound, const float upperBound)
+{
+    order = std::max<size_t>(order, 1);
+    std::vector<zcomplex> poles(order);
+    for (size_t k = 0; k < order; ++k) {
+        const double theta = std::numbers::pi * static_cast<double>(2 * k + order + 1) / static_cast<double>(2 * order);
+        poles[k] = std::polar(1.0, theta);
+        if (std::abs(poles[k].imag()) < 1e-12)
+            poles[k].imag(0.0);
+    }
+
+    return bandpass_from_prototype(poles, 1.0, sampleRate, lowerBound, upperBound);
+}
+
+std::vector<Biquad> chebyshev_bandpass(size_t order, const float rippleDb, const float sampleRate,
+                                       const float lowerBound, const float upperBound)
+{
+    order = std::max<size_t>(order, 1);
+    const double epsilon = std::sqrt(std::pow(10.0, std::max(rippleDb, 1e-3f) / 10.0) - 1.0);
+    const double mu = std::asinh(1.0 / epsilon) / static_cast<double>(order);
+
+    std::vector<zcomplex> poles(order);
+    for (size_t k = 0; k < order; ++k) {
+        const double theta = std::numbers::pi * static_cast<double>(2 * k + 1) / static_cast<double>(2 * order);
+        poles[k] = zcomplex(-std::sinh(mu) * std::sin(theta), std::cosh(mu) * std::cos(theta));
+        if (std::abs(poles[k].imag()) < 1e-12)
+            poles[k].imag(0.0);
+    }
+
+    // Even orders start the passband at the bottom of the ripple.
+    const double gain = order % 2 ? 1.0 : std::pow(10.0, -rippleDb / 20.0);
+    return bandpass_from_prototype(poles, gain, sampleRate, lowerBound, upperBound);
+}
+
+BiquadCascade::BiquadCascade(std::vector<Biquad> sections, const size_t channels)
+: m_sections(std::move(sections))
+, m_channels(std::max<size_t>(channels, 1))
+, m_groups((m_channels + kLanes - 1) / kLanes)
+{
+    reset();
+}
+
+void BiquadCascade::reset()
+{
+    m_state.assign(m_groups * m_sections.size() * 2 * kLanes, 0.f);
+}
+
+void BiquadCascade::process(std::span<const float> in, std::span<float> out)
+{
+    const size_t frames = std::min(in.size(), out.size()) / m_channels;
+    const size_t sectionCount = m_sections.size();
+
+    for (size_t group = 0; group < m_groups; ++group) {
+        const size_t first = group * kLanes;
+        const size_t lanes = std::min(kLanes, m_channels - first);
+        float *state = m_state.data() + group * sectionCount * 2 * kLanes;
+
+        for (size_t start = 0; start < frames; start += kBlockFrames) {
+            const size_t count = std::min(kBlockFrames, frames - start);
+
+            float block[kBlockFrames][kLanes]{};
+            for (size_t t = 0; t < count; ++t) {
+                std::copy_n(in.data() + (start + t) * m_channels + first, lanes, block[t]);
+            }
+
+            // One section at a time over the whole block keeps its state in
+            // registers; the fixed-width lane loops map a group of channels
+            // onto vector registers.
+            for (size_t k = 0; k < sectionCount; ++k) {
+                const Biquad& s = m_sections[k];
+                float s1[kLanes];
+                float s2[kLanes];
+                std::copy_n(state + k * 2 * kLanes, kLanes, s1);
+                std::copy_n(state + k * 2 * kLanes + kLanes, kLanes, s2);
+
+                for (size_t t = 0; t < count; ++t) {
+                    for (size_t lane = 0; lane < kLanes; ++lane) {
+                        const float x = block[t][lane];
+                        const float y = s.b0 * x + s1[lane];
+                        s1[lane] = s.b1 * x - s.a1 * y + s2[lane];
+                        s2[lane] = s.b2 * x - s.a2 * y;
+                        block[t][lane] = y;
+                    }
+                }
+
+                std::copy_n(s1, kLanes, state + k * 2 * kLanes);
+                std::copy_n(s2, kLanes, state + k * 2 * kLanes + kLanes);
+            }
+
+            for (size_t t = 0; t < count; ++t) {
+                std::copy_n(block[t], lanes, out.data() + (start + t) * m_channels + first);
+            }
+        }
+    }
+}
+
+} // namespace filter
@@ -0,0 +1,120 @@
+#include "convolver.h"
+
+#include <algorithm>
+
+namespace filter {
+
+namespace {
+
+using fourier::complex;
+
+// std::complex<float> is layout-compatible with float[2]; multiplying through
+// the floats skips the NaN/Inf recovery of operator* and vectorizes.
+void multiply_accumulate(const complex *a, const complex *b, complex *sum, const size_t count)
+{
+    const auto *x = reinterpret_cast<const float *>(a);
+    const auto *h = reinterpret_cast<const float *>(b);
+    auto *acc = reinterpret_cast<float *>(sum);
+
+    for (size_t k = 0; k < count; ++k) {
+        const float xr = x[2 * k];
+        const float xi = x[2 * k + 1];
+        const float hr = h[2 * k];
+        const float hi = h[2 * k + 1];
+        acc[2 * k] += xr * hr - xi * hi;
+        acc[2 * k + 1] += xr * hi + xi * hr;
+    }
+}
+
+} // namespace
+
+Convolver::Convolver(std::span<const float> kernel, const size_t blockSize, const size_t channels)
+: m_blockSize(std::max<size_t>(blockSize, 1))
+, m_channels(std::max<size_t>(channels, 1))
+, m_partitions(std::max<size_t>((kernel.size() + m_blockSize - 1) / m_blockSize, 1))
+, m_bins(m_blockSize + 1)
+, m_plan(2 * m_blockSize)
+, m_kernel(m_partitions * m_bins)
+, m_sum(m_bins)
+, m_frame(2 * m_blockSize)
+{
+    // The 1 / (2 * blockSize) inverse scaling is folded into the kernel.
+    const float scale = 1.f / static_cast<float>(2 * m_blockSize);
+    for (size_t p = 0; p < m_partitions; ++p) {
+        std::fill(m_frame.begin(), m_frame.end(), 0.f);
+        const auto part = kernel.subspan(std::min(p * m_blockSize, kernel.size()));
+        const size_t count = std::min(part.size(), m_blockSize);
+        std::transform(part.begin(), part.begin() + static_cast<std::ptrdiff_t>(count), m_frame.begin(),
+                       [scale](const float tap) { return tap * scale; });
+
+        m_plan.execute(m_frame, std::span(m_kernel).subspan(p * m_bins, m_bins));
+    }
+
+    reset();
+}
+
+void Convolver::reset()
+{
+    m_delayLine.assign(m_channels * m_partitions * m_bins, complex{});
+    m_history.assign(m_channels * 2 * m_blockSize, 0.f);
+    m_input.assign(m_channels * m_blockSize, 0.f);
+    m_output.assign(m_channels * m_blockSize, 0.f);
+    m_filled = 0;
+    m_head = 0;
+}
+
+void Convolver::process(std::span<const float> in, std::span<float> out)
+{
+    const size_t frames = std::min(in.size(), out.size()) / m_channels;
+
+    for (size_t frame = 0; frame < frames;) {
+        const size_t count = std::min(frames - frame, m_blockSize - m_filled);
+        for (size_t i = 0; i < count; ++i) {
+            for (size_t c = 0; c < m_channels; ++c) {
+                const size_t at = (frame + i) * m_channels + c;
+                const size_t slot = c * m_blockSize + m_filled + i;
+                const float sample = in[at];
+                out[at] = m_output[slot];
+                m_input[slot] = sample;
+            }
+        }
+
+        frame += count;
+        m_filled += count;
+        if (m_filled == m_blockSize) {
+            processBlock();
+            m_filled = 0;
+        }
+    }
+}
+
+void Convolver::processBlock()
+{
+    const auto block = static_cast<std::ptrdiff_t>(m_blockSize);
+
+    for (size_t c = 0; c < m_channels; ++c) {
+        const auto history = m_history.begin() + static_cast<std::ptrdiff_t>(c * 2 * m_blockSize);
+        const auto input = m_input.begin() + static_cast<std::ptrdiff_t>(c * m_blockSize);
+        std::copy(history + block, history + 2 * block, history);
+        std::copy(input, input + block, history + block);
+
+        const complex *delayLine = m_delayLine.data() + c * m_partitions * m_bins;
+        m_plan.execute(std::span(history, 2 * m_blockSize),
+                       std::span(m_delayLine).subspan((c * m_partitions + m_head) * m_bins, m_bins));
+
+        std::fill(m_sum.begin(), m_sum.end(), complex{});
+        for (size_t p = 0; p < m_partitions; ++p) {
+            const size_t slot = (m_head + m_partitions - p) % m_partitions;
+            multiply_accumulate(delayLine + slot * m_bins, m_kernel.data() + p * m_bins, m_sum.data(), m_bins);
+        }
+
+        // Overlap-save: the first half of the circular result is aliased.
+        m_plan.executeInverse(m_sum, m_frame);
+        std::copy(m_frame.begin() + block, m_frame.end(),
+                  m_output.begin() + static_cast<std::ptrdiff_t>(c * m_blockSize));
+    }
+
+    m_head = (m_head + 1) % m_partitions;
+}
+
+} // namespace filter
@@ -0,0 +1,144 @@
+#include "fft_kernels.h"
+#include "fft_plan.h"
+#include "fft_radix4.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FOURIER_HAVE_SSE2
+#endif
+
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define FOURIER_HAVE_NEON
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace fourier::kernels {
+
+namespace {
+
+#ifdef FOURIER_HAVE_SSE2
+struct Sse2Vec {
+    using type = __m128;
+    static constexpr size_t width = 4;
+
+    static type load(const float *p) { return _mm_loadu_ps(p); }
+    static void store(float *p, type v) { _mm_storeu_ps(p, v); }
+    static type add(type a, type b) { return _mm_add_ps(a, b); }
+    static type sub(type a, type b) { return _mm_sub_ps(a, b); }
+    static type mul(type a, type b) { return _mm_mul_ps(a, b); }
+    static type fmadd(type a, type b, type c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    static type fmsub(type a, type b, type c) { return _mm_sub_ps(_mm_mul_ps(a, b), c); }
+};
+#endif
+
+#ifdef FOURIER_HAVE_NEON
+struct NeonVec {
+    using type = float32x4_t;
+    static constexpr size_t width = 4;
+
+    static type load(const float *p) { return vld1q_f32(p); }
+    static void store(float *p, type v) { vst1q_f32(p, v); }
+    static type add(type a, type b) { return vaddq_f32(a, b); }
+    static type sub(type a, type b) { return vsubq_f32(a, b); }
+    static type mul(type a, type b) { return vmulq_f32(a, b); }
+    static type fmadd(type a, type b, type c) { return vmlaq_f32(c, a, b); }
+    static type fmsub(type a, type b, type c) { return vnegq_f32(vmlsq_f32(c, a, b)); }
+};
+#endif
+
+bool cpu_has_avx2()
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4]{};
+    __cpuid(info, 1);
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!fma || !osxsave || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+void radix4_scalar(float *re, float *im, const size_t size, const size_t quarter, const float *twiddles)
+{
+    radix4_pass<ScalarVec>(re, im, size, quarter, twiddles);
+}
+
+#ifdef FOURIER_HAVE_SSE2
+void radix4_sse2(float *re, float *im, const size_t size, const size_t quarter, const float *twiddles)
+{
+    radix4_pass<Sse2Vec>(re, im, size, quarter, twiddles);
+}
+#endif
+
+#ifdef FOURIER_HAVE_NEON
+void radix4_neon(float *re, float *im, const size_t size, const size_t quarter, const float *twiddles)
+{
+    radix4_pass<NeonVec>(re, im, size, quarter, twiddles);
+}
+#endif
+
+bool is_supported(const SimdLevel level)
+{
+    switch (level) {
+        case SimdLevel::SCALAR:
+            return true;
+#ifdef FOURIER_HAVE_AVX2_KERNELS
+        case SimdLevel::AVX2:
+            return cpu_has_avx2();
+#endif
+#ifdef FOURIER_HAVE_SSE2
+        case SimdLevel::SSE2:
+            return true;
+#endif
+#ifdef FOURIER_HAVE_NEON
+        case SimdLevel::NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+SimdLevel best_level()
+{
+    for (const auto level : {SimdLevel::AVX2, SimdLevel::SSE2, SimdLevel::NEON}) {
+        if (is_supported(level))
+            return level;
+    }
+    return SimdLevel::SCALAR;
+}
+
+Radix4Pass radix4_for(const SimdLevel level)
+{
+    switch (level) {
+#ifdef FOURIER_HAVE_AVX2_KERNELS
+        case SimdLevel::AVX2:
+            return radix4_avx2;
+#endif
+#ifdef FOURIER_HAVE_SSE2
+        case SimdLevel::SSE2:
+            return radix4_sse2;
+#endif
+#ifdef FOURIER_HAVE_NEON
+        case SimdLevel::NEON:
+            return radix4_neon;
+#endif
+        default:
+            return radix4_scalar;
+    }
+}
+
+} // namespace fourier::kernels
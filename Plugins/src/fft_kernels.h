@@ -0,0 +1,33 @@
+#ifndef FFT_KERNELS_H
+#define FFT_KERNELS_H
+
+#include <cstddef>
+
+// Kept free of standard library headers: fft_kernels_avx2.cpp is compiled
+// with wider instruction sets and must not emit shared inline functions.
+namespace fourier {
+
+enum class SimdLevel;
+
+namespace kernels {
+
+// One radix-4 pass over split real/imaginary arrays. Blocks of `quarter`
+// points are already transformed; afterwards blocks of 4 * quarter are.
+// twiddles holds four arrays of `quarter` floats: w1 re/im, then w2 re/im,
+// where w1 = exp(-2 pi i j / (2 quarter)) and w2 = exp(-2 pi i j / (4 quarter)).
+using Radix4Pass = void (*)(float *re, float *im, size_t size, size_t quarter, const float *twiddles);
+
+void radix4_scalar(float *re, float *im, size_t size, size_t quarter, const float *twiddles);
+void radix4_sse2(float *re, float *im, size_t size, size_t quarter, const float *twiddles);
+void radix4_avx2(float *re, float *im, size_t size, size_t quarter, const float *twiddles);
+void radix4_neon(float *re, float *im, size_t size, size_t quarter, const float *twiddles);
+
+bool is_supported(SimdLevel level);
+SimdLevel best_level();
+Radix4Pass radix4_for(SimdLevel level);
+
+} // namespace kernels
+
+} // namespace fourier
+
+#endif //FFT_KERNELS_H
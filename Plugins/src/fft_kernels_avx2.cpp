@@ -0,0 +1,35 @@
+#include "fft_kernels.h"
+#include "fft_radix4.h"
+
+// Built with AVX2 and FMA enabled, see CMakeLists.txt. Only reached after
+// the runtime CPU check in fft_kernels.cpp.
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+
+namespace fourier::kernels {
+
+namespace {
+
+struct Avx2Vec {
+    using type = __m256;
+    static constexpr size_t width = 8;
+
+    static type load(const float *p) { return _mm256_loadu_ps(p); }
+    static void store(float *p, type v) { _mm256_storeu_ps(p, v); }
+    static type add(type a, type b) { return _mm256_add_ps(a, b); }
+    static type sub(type a, type b) { return _mm256_sub_ps(a, b); }
+    static type mul(type a, type b) { return _mm256_mul_ps(a, b); }
+    static type fmadd(type a, type b, type c) { return _mm256_fmadd_ps(a, b, c); }
+    static type fmsub(type a, type b, type c) { return _mm256_fmsub_ps(a, b, c); }
+};
+
+} // namespace
+
+void radix4_avx2(float *re, float *im, const size_t size, const size_t quarter, const float *twiddles)
+{
+    radix4_pass<Avx2Vec>(re, im, size, quarter, twiddles);
+}
+
+} // namespace fourier::kernels
+
+#endif
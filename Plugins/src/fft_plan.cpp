@@ -0,0 +1,577 @@
+#include "fft_plan.h"
+#include "fft_kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <numbers>
+
+namespace fourier {
+
+namespace {
+
+using namespace utils;
+
+constexpr size_t kBlockColumns{ 8 };
+constexpr int kMinFourStepBits{ 8 };
+
+std::atomic<size_t> fourStepThreshold{ size_t{1} << 21 };
+
+complex twiddle(const size_t index, const size_t size)
+{
+    const double phase = -2.0 * std::numbers::pi * static_cast<double>(index) / static_cast<double>(size);
+    return {static_cast<float>(std::cos(phase)), static_cast<float>(std::sin(phase))};
+}
+
+// One radix-R pass over blocks of R * span points; butterfly inputs are
+// scaled by twiddles laid out as [q - 1][re | im][j] before the R-point DFT.
+template<size_t R>
+void odd_radix_pass(float *re, float *im, const size_t size, const size_t span,
+                    const float *twiddles, const float *roots)
+{
+    constexpr size_t half = (R - 1) / 2;
+    const float *cosines = roots;
+    const float *sines = roots + half * half;
+
+    for (size_t base = 0; base < size; base += R * span) {
+        for (size_t j = 0; j < span; ++j) {
+            float xr[R];
+            float xi[R];
+            xr[0] = re[base + j];
+            xi[0] = im[base + j];
+            for (size_t q = 1; q < R; ++q) {
+                const float r = re[base + j + q * span];
+                const float i = im[base + j + q * span];
+                const float wr = twiddles[(q - 1) * 2 * span + j];
+                const float wi = twiddles[(q - 1) * 2 * span + span + j];
+                xr[q] = r * wr - i * wi;
+                xi[q] = r * wi + i * wr;
+            }
+
+            float sumRe = xr[0];
+            float sumIm = xi[0];
+            for (size_t q = 1; q <= half; ++q) {
+                sumRe += xr[q] + xr[R - q];
+                sumIm += xi[q] + xi[R - q];
+            }
+            re[base + j] = sumRe;
+            im[base + j] = sumIm;
+
+            // y[p] and y[R - p] share the cosine terms and differ in the sign
+            // of the sine terms.
+            for (size_t p = 1; p <= half; ++p) {
+                float ar = xr[0];
+                float ai = xi[0];
+                float br = 0.f;
+                float bi = 0.f;
+                for (size_t q = 1; q <= half; ++q) {
+                    const float c = cosines[(p - 1) * half + q - 1];
+                    const float s = sines[(p - 1) * half + q - 1];
+                    ar += c * (xr[q] + xr[R - q]);
+                    ai += c * (xi[q] + xi[R - q]);
+                    br += s * (xr[q] - xr[R - q]);
+                    bi += s * (xi[q] - xi[R - q]);
+                }
+                re[base + j + p * span] = ar + bi;
+                im[base + j + p * span] = ai - br;
+                re[base + j + (R - p) * span] = ar - bi;
+                im[base + j + (R - p) * span] = ai + br;
+            }
+        }
+    }
+}
+
+void transpose_square(complex *data, const size_t n)
+{
+    constexpr size_t tile{ 16 };
+    for (size_t i0 = 0; i0 < n; i0 += tile) {
+        for (size_t j0 = i0; j0 < n; j0 += tile) {
+            for (size_t i = i0; i < std::min(i0 + tile, n); ++i) {
+                for (size_t j = std::max(j0, i + 1); j < std::min(j0 + tile, n); ++j) {
+                    std::swap(data[i * n + j], data[j * n + i]);
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+SimdLevel best_simd_level()
+{
+    return kernels::best_level();
+}
+
+void set_four_step_threshold(const size_t size) noexcept
+{
+    fourStepThreshold = size;
+}
+
+size_t four_step_threshold() noexcept
+{
+    return fourStepThreshold;
+}
+
+FftPlan::FftPlan(const size_t size, const SimdLevel simd)
+: FftPlan(size, simd, true)
+{}
+
+FftPlan::FftPlan(const size_t size, const SimdLevel simd, const bool allowFourStep)
+: m_size(std::max<size_t>(size, 1))
+, m_simd(kernels::is_supported(simd) ? simd : kernels::best_level())
+, m_pass(kernels::radix4_for(m_simd))
+{
+    size_t rest = m_size;
+    m_bits = std::countr_zero(rest);
+    rest >>= m_bits;
+
+    std::vector<size_t> oddRadices;
+    for (const size_t radix : {3, 5, 7}) {
+        while (rest % radix == 0) {
+            oddRadices.push_back(radix);
+            rest /= radix;
+        }
+    }
+
+    if (rest != 1)
+        prepareBluestein();
+    else if (allowFourStep && oddRadices.empty() && m_size > four_step_threshold() && m_bits >= kMinFourStepBits)
+        prepareFourStep();
+    else
+        prepareDirect(oddRadices);
+}
+
+// Stages run in the order: power-of-two passes (radix-2 first if the
+// exponent is odd, then SIMD radix-4), then the odd radices, whose spans are
+// already wide enough to vectorize. The input is loaded in the matching
+// digit-reversed order.
+void FftPlan::prepareDirect(const std::vector<size_t>& oddRadices)
+{
+    const size_t pow2 = size_t{1} << m_bits;
+    for (size_t quarter = m_bits % 2 ? 2 : 1; 4 * quarter <= pow2; quarter *= 4) {
+        const size_t offset = m_twiddles.size();
+        m_twiddles.resize(offset + 4 * quarter);
+        for (size_t j = 0; j < quarter; ++j) {
+            const double phase = -std::numbers::pi * static_cast<double>(j) / static_cast<double>(quarter);
+            m_twiddles[offset + j] = static_cast<float>(std::cos(phase));
+            m_twiddles[offset + quarter + j] = static_cast<float>(std::sin(phase));
+            m_twiddles[offset + 2 * quarter + j] = static_cast<float>(std::cos(phase / 2));
+            m_twiddles[offset + 3 * quarter + j] = static_cast<float>(std::sin(phase / 2));
+        }
+    }
+
+    size_t span = pow2;
+    for (const size_t radix : oddRadices) {
+        const OddStage stage{radix, span, m_oddTwiddles.size(), m_roots.size()};
+
+        m_oddTwiddles.resize(stage.twiddles + 2 * (radix - 1) * span);
+        for (size_t q = 1; q < radix; ++q) {
+            for (size_t j = 0; j < span; ++j) {
+                const complex w = twiddle(j * q, radix * span);
+                m_oddTwiddles[stage.twiddles + (q - 1) * 2 * span + j] = w.real();
+                m_oddTwiddles[stage.twiddles + (q - 1) * 2 * span + span + j] = w.imag();
+            }
+        }
+
+        const size_t half = (radix - 1) / 2;
+        m_roots.resize(stage.roots + 2 * half * half);
+        for (size_t p = 1; p <= half; ++p) {
+            for (size_t q = 1; q <= half; ++q) {
+                const double angle = 2.0 * std::numbers::pi * static_cast<double>(p * q) / static_cast<double>(radix);
+                m_roots[stage.roots + (p - 1) * half + q - 1] = static_cast<float>(std::cos(angle));
+                m_roots[stage.roots + half * half + (p - 1) * half + q - 1] = static_cast<float>(std::sin(angle));
+            }
+        }
+
+        m_oddStages.push_back(stage);
+        span *= radix;
+    }
+
+    std::vector<size_t> factors(m_bits, 2);
+    factors.insert(factors.end(), oddRadices.begin(), oddRadices.end());
+
+    m_reversal.resize(m_size);
+    for (size_t i = 0; i < m_size; ++i) {
+        size_t index = i;
+        size_t position = 0;
+        size_t weight = m_size;
+        for (auto it = factors.rbegin(); it != factors.rend(); ++it) {
+            weight /= *it;
+            position += (index % *it) * weight;
+            index /= *it;
+        }
+        m_reversal[position] = static_cast<unsigned int>(i);
+    }
+
+    m_re.resize(m_size);
+    m_im.resize(m_size);
+}
+
+void FftPlan::prepareFourStep()
+{
+    m_rows = size_t{1} << ((m_bits + 1) / 2);
+    m_cols = size_t{1} << (m_bits / 2);
+    m_steps.push_back(FftPlan(m_rows, m_simd, false));
+    m_steps.push_back(FftPlan(m_cols, m_simd, false));
+
+    m_coarse.resize(m_rows);
+    for (size_t i = 0; i < m_rows; ++i) {
+        m_coarse[i] = twiddle(i * m_cols, m_size);
+    }
+    m_fine.resize(m_cols);
+    for (size_t i = 0; i < m_cols; ++i) {
+        m_fine[i] = twiddle(i, m_size);
+    }
+
+    m_block.resize(kBlockColumns * m_rows);
+
+    // A 2m x m transpose is two square transposes followed by a perfect
+    // shuffle of m-point rows, done by cycle following: p -> 2p mod (2m - 1).
+    if (m_rows != m_cols) {
+        const size_t modulus = m_rows - 1;
+        std::vector<bool> visited(m_rows);
+        for (size_t start = 1; start < modulus; ++start) {
+            if (visited[start])
+                continue;
+            m_cycles.push_back(start);
+            for (size_t p = start; !visited[p]; p = 2 * p % modulus) {
+                visited[p] = true;
+            }
+        }
+    }
+}
+
+void FftPlan::prepareBluestein()
+{
+    const size_t length = std::bit_ceil(2 * m_size - 1);
+    m_convolution.push_back(FftPlan(length, m_simd));
+
+    // n^2 is reduced modulo 2N first to keep the phase accurate for large n.
+    m_chirp.resize(m_size);
+    for (size_t n = 0; n < m_size; ++n) {
+        const auto square = static_cast<unsigned long long>(n) * n % (2 * m_size);
+        const double phase = -std::numbers::pi * static_cast<double>(square) / static_cast<double>(m_size);
+        m_chirp[n] = complex(static_cast<float>(std::cos(phase)), static_cast<float>(std::sin(phase)));
+    }
+
+    m_kernel.assign(length, complex{});
+    m_kernel[0] = std::conj(m_chirp[0]);
+    for (size_t n = 1; n < m_size; ++n) {
+        m_kernel[n] = std::conj(m_chirp[n]);
+        m_kernel[length - n] = std::conj(m_chirp[n]);
+    }
+    m_convolution[0].execute(m_kernel);
+
+    const float scale = 1.f / static_cast<float>(length);
+    for (auto& value : m_kernel) {
+        value *= scale;
+    }
+
+    m_work.resize(length);
+}
+
+void FftPlan::execute(std::span<const complex> in, std::span<complex> out)
+{
+    transform(in, out, false);
+}
+
+void FftPlan::executeInverse(std::span<const complex> in, std::span<complex> out)
+{
+    transform(in, out, true);
+}
+
+template<typename Load, typename Store>
+void FftPlan::run(const Load& load, const Store& store, const bool inverse)
+{
+    for (size_t i = 0; i < m_size; ++i) {
+        const complex value = load(m_reversal[i]);
+        m_re[i] = value.real();
+        m_im[i] = value.imag();
+    }
+
+    // The inverse is the forward transform with real and imaginary parts swapped.
+    float *re = inverse ? m_im.data() : m_re.data();
+    float *im = inverse ? m_re.data() : m_im.data();
+
+    if (m_bits % 2) {
+        for (size_t i = 0; i < m_size; i += 2) {
+            const float r0 = re[i];
+            const float i0 = im[i];
+            re[i] = r0 + re[i + 1];
+            im[i] = i0 + im[i + 1];
+            re[i + 1] = r0 - re[i + 1];
+            im[i + 1] = i0 - im[i + 1];
+        }
+    }
+
+    const size_t pow2 = size_t{1} << m_bits;
+    const float *twiddles = m_twiddles.data();
+    for (size_t quarter = m_bits % 2 ? 2 : 1; 4 * quarter <= pow2; quarter *= 4) {
+        m_pass(re, im, m_size, quarter, twiddles);
+        twiddles += 4 * quarter;
+    }
+
+    for (const auto& stage : m_oddStages) {
+        const float *stageTwiddles = m_oddTwiddles.data() + stage.twiddles;
+        const float *roots = m_roots.data() + stage.roots;
+        switch (stage.radix) {
+            case 3:
+                odd_radix_pass<3>(re, im, m_size, stage.span, stageTwiddles, roots);
+                break;
+            case 5:
+                odd_radix_pass<5>(re, im, m_size, stage.span, stageTwiddles, roots);
+                break;
+            case 7:
+                odd_radix_pass<7>(re, im, m_size, stage.span, stageTwiddles, roots);
+                break;
+            default:
+                break;
+        }
+    }
+
+    for (size_t i = 0; i < m_size; ++i) {
+        store(i, m_re[i], m_im[i]);
+    }
+}
+
+void FftPlan::transform(std::span<const complex> in, std::span<complex> out, const bool inverse)
+{
+    assert(out.size() >= m_size);
+    in = in.first(std::min(in.size(), m_size));
+
+    if (isFourStep()) {
+        transformFourStep(in, out.first(m_size), inverse);
+        return;
+    }
+    if (isBluestein()) {
+        transformBluestein(in, out.first(m_size), inverse);
+        return;
+    }
+
+    run([in](const size_t i) { return i < in.size() ? in[i] : complex{}; },
+        [out](const size_t i, const float re, const float im) { out[i] = complex(re, im); },
+        inverse);
+}
+
+// Bailey's four-step: with x as an m_rows x m_cols matrix, transform the
+// columns, scale by w^(c * k), transform the rows and transpose. Columns are
+// copied through m_block a cache line at a time and written back only after
+// they were read, so in == out is safe and no full-size scratch is needed.
+void FftPlan::transformFourStep(std::span<const complex> in, std::span<complex> out, const bool inverse)
+{
+    auto& columns = m_steps[0];
+    auto& rows = m_steps[1];
+    const size_t width = m_block.size() / m_rows;
+    const int colBits = std::countr_zero(m_cols);
+    const float sign = inverse ? -1.f : 1.f;
+
+    for (size_t c0 = 0; c0 < m_cols; c0 += width) {
+        for (size_t r = 0; r < m_rows; ++r) {
+            for (size_t b = 0; b < width; ++b) {
+                const size_t index = r * m_cols + c0 + b;
+                m_block[b * m_rows + r] = index < in.size() ? in[index] : complex{};
+            }
+        }
+
+        for (size_t b = 0; b < width; ++b) {
+            complex *column = m_block.data() + b * m_rows;
+            const size_t c = c0 + b;
+            const auto load = [column](const size_t r) {
+                return column[r];
+            };
+            const auto store = [&](const size_t k, const float re, const float im) {
+                const size_t e = c * k;
+                const complex u = m_coarse[e >> colBits];
+                const complex v = m_fine[e & (m_cols - 1)];
+                const float wr = u.real() * v.real() - u.imag() * v.imag();
+                const float wi = sign * (u.real() * v.imag() + u.imag() * v.real());
+                column[k] = complex(re * wr - im * wi, re * wi + im * wr);
+            };
+            columns.run(load, store, inverse);
+        }
+
+        for (size_t r = 0; r < m_rows; ++r) {
+            for (size_t b = 0; b < width; ++b) {
+                out[r * m_cols + c0 + b] = m_block[b * m_rows + r];
+            }
+        }
+    }
+
+    for (size_t r = 0; r < m_rows; ++r) {
+        const auto row = out.subspan(r * m_cols, m_cols);
+        if (inverse)
+            rows.executeInverse(row);
+        else
+            rows.execute(row);
+    }
+
+    transpose(out);
+}
+
+// X[k] = c[k] * sum(x[n] c[n] conj(c[k - n])) with c[n] = exp(-i pi n^2 / N),
+// a circular convolution evaluated with power-of-two transforms. The inverse
+// swaps real and imaginary parts on the way in and out.
+void FftPlan::transformBluestein(std::span<const complex> in, std::span<complex> out, const bool inverse)
+{
+    const auto swapped = [inverse](const complex value) {
+        return inverse ? complex(value.imag(), value.real()) : value;
+    };
+
+    for (size_t n = 0; n < m_size; ++n) {
+        const complex value = n < in.size() ? swapped(in[n]) : complex{};
+        m_work[n] = value * m_chirp[n];
+    }
+    std::fill(m_work.begin() + static_cast<std::ptrdiff_t>(m_size), m_work.end(), complex{});
+
+    auto& convolution = m_convolution[0];
+    convolution.execute(m_work);
+    for (size_t k = 0; k < m_work.size(); ++k) {
+        m_work[k] *= m_kernel[k];
+    }
+    convolution.executeInverse(m_work);
+
+    for (size_t k = 0; k < m_size; ++k) {
+        out[k] = swapped(m_work[k] * m_chirp[k]);
+    }
+}
+
+void FftPlan::transpose(std::span<complex> data)
+{
+    if (m_rows == m_cols) {
+        transpose_square(data.data(), m_cols);
+        return;
+    }
+
+    const size_t side = m_cols;
+    transpose_square(data.data(), side);
+    transpose_square(data.data() + side * side, side);
+
+    const size_t modulus = m_rows - 1;
+    const auto block = [&](const size_t index) {
+        return data.subspan(index * side, side);
+    };
+    const auto temp = std::span(m_block).first(side);
+
+    for (const size_t start : m_cycles) {
+        std::ranges::copy(block(start), temp.begin());
+        size_t current = start;
+        for (size_t source = current * side % modulus; source != start; source = current * side % modulus) {
+            std::ranges::copy(block(source), block(current).begin());
+            current = source;
+        }
+        std::ranges::copy(temp, block(current).begin());
+    }
+}
+
+RealFftPlan::RealFftPlan(const size_t size, const SimdLevel simd)
+: m_size(std::max<size_t>(size, 1)), m_plan(m_size % 2 ? m_size : m_size / 2, simd)
+{
+    m_packed.resize(m_plan.size());
+    m_unpacked.resize(m_plan.size());
+    if (m_size % 2)
+        return;
+
+    const size_t half = m_size / 2;
+    m_twiddles.resize(half);
+    for (size_t i = 0; i < half; ++i) {
+        const double phase = -2.0 * std::numbers::pi * static_cast<double>(i) / static_cast<double>(m_size);
+        m_twiddles[i] = complex(static_cast<float>(std::cos(phase)), static_cast<float>(std::sin(phase)));
+    }
+}
+
+void RealFftPlan::execute(std::span<const float> in, std::span<complex> out)
+{
+    assert(out.size() >= bins());
+    in = in.first(std::min(in.size(), m_size));
+
+    if (m_size % 2) {
+        for (size_t i = 0; i < m_size; ++i) {
+            m_packed[i] = complex(i < in.size() ? in[i] : 0.f, 0.f);
+        }
+        m_plan.execute(m_packed, m_unpacked);
+        std::copy_n(m_unpacked.begin(), bins(), out.begin());
+        return;
+    }
+
+    const size_t half = m_size / 2;
+    for (size_t i = 0; i < half; ++i) {
+        const float re = 2 * i < in.size() ? in[2 * i] : 0.f;
+        const float im = 2 * i + 1 < in.size() ? in[2 * i + 1] : 0.f;
+        m_packed[i] = complex(re, im);
+    }
+
+    m_plan.execute(m_packed, out);
+
+    // Split Z = FFT(even + i * odd) into the even and odd spectra and merge
+    // them with one twiddle, handling bins k and N / 2 - k together.
+    const complex dc = out[0];
+    out[0] = complex(dc.real() + dc.imag(), 0.f);
+    out[half] = complex(dc.real() - dc.imag(), 0.f);
+
+    for (size_t k = 1; k <= half / 2; ++k) {
+        const complex a = out[k];
+        const complex b = out[half - k];
+        const complex w = m_twiddles[k];
+
+        const float evenRe = 0.5f * (a.real() + b.real());
+        const float evenIm = 0.5f * (a.imag() - b.imag());
+        const float oddRe = 0.5f * (a.imag() + b.imag());
+        const float oddIm = -0.5f * (a.real() - b.real());
+
+        const float twRe = w.real() * oddRe - w.imag() * oddIm;
+        const float twIm = w.real() * oddIm + w.imag() * oddRe;
+
+        out[k] = complex(evenRe + twRe, evenIm + twIm);
+        out[half - k] = complex(evenRe - twRe, twIm - evenIm);
+    }
+}
+
+void RealFftPlan::executeInverse(std::span<const complex> in, std::span<float> out)
+{
+    assert(in.size() >= bins());
+    assert(out.size() >= m_size);
+
+    if (m_size % 2) {
+        m_packed[0] = complex(in[0].real(), 0.f);
+        for (size_t k = 1; k < bins(); ++k) {
+            m_packed[k] = in[k];
+            m_packed[m_size - k] = std::conj(in[k]);
+        }
+        m_plan.executeInverse(m_packed, m_unpacked);
+        for (size_t i = 0; i < m_size; ++i) {
+            out[i] = m_unpacked[i].real();
+        }
+        return;
+    }
+
+    const size_t half = m_size / 2;
+    m_packed[0] = complex(in[0].real() + in[half].real(), in[0].real() - in[half].real());
+
+    for (size_t k = 1; k <= half / 2; ++k) {
+        const complex a = in[k];
+        const complex b = in[half - k];
+        const complex w = std::conj(m_twiddles[k]);
+
+        const float evenRe = a.real() + b.real();
+        const float evenIm = a.imag() - b.imag();
+        const float diffRe = a.real() - b.real();
+        const float diffIm = a.imag() + b.imag();
+
+        const float oddRe = w.real() * diffRe - w.imag() * diffIm;
+        const float oddIm = w.real() * diffIm + w.imag() * diffRe;
+
+        m_packed[k] = complex(evenRe - oddIm, evenIm + oddRe);
+        m_packed[half - k] = complex(evenRe + oddIm, oddRe - evenIm);
+    }
+
+    m_plan.executeInverse(m_packed, m_unpacked);
+
+    for (size_t i = 0; i < half; ++i) {
+        out[2 * i] = m_unpacked[i].real();
+        out[2 * i + 1] = m_unpacked[i].imag();
+    }
+}
+
+} // namespace fourier
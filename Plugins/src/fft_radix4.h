@@ -0,0 +1,106 @@
+#ifndef FFT_RADIX4_H
+#define FFT_RADIX4_H
+
+#include <cstddef>
+
+// Included by every kernel translation unit with its own vector type. The
+// anonymous namespace keeps instantiations built with different instruction
+// sets from being merged by the linker.
+namespace fourier::kernels {
+
+namespace {
+
+// Vector types provide: type, width, load, store, add, sub, mul, fmadd, fmsub.
+struct ScalarVec {
+    using type = float;
+    static constexpr size_t width = 1;
+
+    static type load(const float *p) { return *p; }
+    static void store(float *p, type v) { *p = v; }
+    static type add(type a, type b) { return a + b; }
+    static type sub(type a, type b) { return a - b; }
+    static type mul(type a, type b) { return a * b; }
+    static type fmadd(type a, type b, type c) { return a * b + c; }
+    static type fmsub(type a, type b, type c) { return a * b - c; }
+};
+
+template<typename V>
+void radix4_block(float *re, float *im, const size_t quarter, const float *twiddles, const size_t j)
+{
+    using T = typename V::type;
+
+    const float *w1re = twiddles;
+    const float *w1im = twiddles + quarter;
+    const float *w2re = twiddles + 2 * quarter;
+    const float *w2im = twiddles + 3 * quarter;
+
+    const T x0r = V::load(re + j);
+    const T x0i = V::load(im + j);
+    const T x1r = V::load(re + j + quarter);
+    const T x1i = V::load(im + j + quarter);
+    const T x2r = V::load(re + j + 2 * quarter);
+    const T x2i = V::load(im + j + 2 * quarter);
+    const T x3r = V::load(re + j + 3 * quarter);
+    const T x3i = V::load(im + j + 3 * quarter);
+
+    const T ar = V::load(w1re + j);
+    const T ai = V::load(w1im + j);
+    const T br = V::load(w2re + j);
+    const T bi = V::load(w2im + j);
+
+    // First radix-2 stage: pairs (x0, x1) and (x2, x3) with twiddle w1.
+    const T t1r = V::fmsub(x1r, ar, V::mul(x1i, ai));
+    const T t1i = V::fmadd(x1r, ai, V::mul(x1i, ar));
+    const T t3r = V::fmsub(x3r, ar, V::mul(x3i, ai));
+    const T t3i = V::fmadd(x3r, ai, V::mul(x3i, ar));
+
+    const T a0r = V::add(x0r, t1r);
+    const T a0i = V::add(x0i, t1i);
+    const T a1r = V::sub(x0r, t1r);
+    const T a1i = V::sub(x0i, t1i);
+    const T a2r = V::add(x2r, t3r);
+    const T a2i = V::add(x2i, t3i);
+    const T a3r = V::sub(x2r, t3r);
+    const T a3i = V::sub(x2i, t3i);
+
+    // Second stage: twiddle w2 for the upper half, -i * w2 for the lower.
+    const T u2r = V::fmsub(a2r, br, V::mul(a2i, bi));
+    const T u2i = V::fmadd(a2r, bi, V::mul(a2i, br));
+    const T u3r = V::fmadd(a3r, bi, V::mul(a3i, br));
+    const T u3i = V::fmsub(a3i, bi, V::mul(a3r, br));
+
+    V::store(re + j, V::add(a0r, u2r));
+    V::store(im + j, V::add(a0i, u2i));
+    V::store(re + j + quarter, V::add(a1r, u3r));
+    V::store(im + j + quarter, V::add(a1i, u3i));
+    V::store(re + j + 2 * quarter, V::sub(a0r, u2r));
+    V::store(im + j + 2 * quarter, V::sub(a0i, u2i));
+    V::store(re + j + 3 * quarter, V::sub(a1r, u3r));
+    V::store(im + j + 3 * quarter, V::sub(a1i, u3i));
+}
+
+template<typename V>
+void radix4_loop(float *re, float *im, const size_t size, const size_t quarter, const float *twiddles)
+{
+    for (size_t base = 0; base < size; base += 4 * quarter) {
+        for (size_t j = 0; j < quarter; j += V::width) {
+            radix4_block<V>(re + base, im + base, quarter, twiddles, j);
+        }
+    }
+}
+
+// The first passes have fewer butterflies per block than vector lanes.
+template<typename V>
+void radix4_pass(float *re, float *im, const size_t size, const size_t quarter, const float *twiddles)
+{
+    if (quarter < V::width)
+        radix4_loop<ScalarVec>(re, im, size, quarter, twiddles);
+    else
+        radix4_loop<V>(re, im, size, quarter, twiddles);
+}
+
+} // namespace
+
+} // namespace fourier::kernels
+
+#endif //FFT_RADIX4_H
@@ -1,6 +1,8 @@
 #include "filter.h"
 
 #include <algorithm>
+#include <cmath>
+#include <numbers>
 
 namespace filter {
 
@@ -19,4 +21,102 @@ std::vector<complex> filter(std::span<const complex> input, std::span<const floa
     return result;
 }
 
-}
\ No newline at end of file
+namespace {
+
+// Ideal low-pass impulse response 2 fc sinc(2 fc (n - center)), fc in cycles per sample.
+double ideal_lowpass(const double cutoff, const double offset)
+{
+    if (offset == 0.0)
+        return 2.0 * cutoff;
+    return std::sin(2.0 * std::numbers::pi * cutoff * offset) / (std::numbers::pi * offset);
+}
+
+double gain_at(std::span<const double> taps, const double frequency)
+{
+    std::complex<double> sum{};
+    for (size_t n = 0; n < taps.size(); ++n) {
+        sum += taps[n] * std::polar(1.0, -2.0 * std::numbers::pi * frequency * static_cast<double>(n));
+    }
+    return std::abs(sum);
+}
+
+} // namespace
+
+std::vector<float> design_fir(const FilterType type, size_t taps, const float sampleRate, const float lower,
+                              const float upper, const WindowType window, const float kaiserBeta)
+{
+    taps = std::max<size_t>(taps, 1);
+    if ((type == FilterType::HIGHPASS || type == FilterType::NOTCH) && taps % 2 == 0)
+        ++taps;
+
+    const double low = std::clamp(static_cast<double>(lower) / sampleRate, 0.0, 0.5);
+    const double high = std::clamp(static_cast<double>(upper) / sampleRate, low, 0.5);
+    const double center = static_cast<double>(taps - 1) / 2.0;
+    const auto shape = make_window(window, taps, false, kaiserBeta);
+
+    std::vector<double> response(taps);
+    for (size_t n = 0; n < taps; ++n) {
+        const double offset = static_cast<double>(n) - center;
+        const double impulse = offset == 0.0 ? 1.0 : 0.0;
+        double value = 0.0;
+        switch (type) {
+            case FilterType::LOWPASS:
+                value = ideal_lowpass(low, offset);
+                break;
+            case FilterType::HIGHPASS:
+                value = impulse - ideal_lowpass(low, offset);
+                break;
+            case FilterType::BANDPASS:
+                value = ideal_lowpass(high, offset) - ideal_lowpass(low, offset);
+                break;
+            case FilterType::NOTCH:
+                value = impulse - ideal_lowpass(high, offset) + ideal_lowpass(low, offset);
+                break;
+        }
+        response[n] = value * shape[n];
+    }
+
+    double reference = 0.0;
+    switch (type) {
+        case FilterType::LOWPASS:
+        case FilterType::NOTCH:
+            reference = 0.0;
+            break;
+        case FilterType::HIGHPASS:
+            reference = 0.5;
+            break;
+        case FilterType::BANDPASS:
+            reference = (low + high) / 2.0;
+            break;
+    }
+
+    const double gain = gain_at(response, reference);
+    std::vector<float> result(taps);
+    for (size_t n = 0; n < taps; ++n) {
+        result[n] = static_cast<float>(gain > 0.0 ? response[n] / gain : response[n]);
+    }
+
+    return result;
+}
+
+float kaiser_beta(const float attenuationDb)
+{
+    const double a = attenuationDb;
+    if (a > 50.0)
+        return static_cast<float>(0.1102 * (a - 8.7));
+    if (a >= 21.0)
+        return static_cast<float>(0.5842 * std::pow(a - 21.0, 0.4) + 0.07886 * (a - 21.0));
+    return 0.f;
+}
+
+size_t kaiser_taps(const float attenuationDb, const float transitionHz, const float sampleRate)
+{
+    const double width = static_cast<double>(transitionHz) / sampleRate;
+    if (width <= 0.0)
+        return 1;
+
+    const double order = std::ceil((attenuationDb - 7.95) / (14.36 * width));
+    return static_cast<size_t>(std::max(order, 0.0)) + 1;
+}
+
+}
@@ -3,7 +3,11 @@
 #include <cmath>
 #include <numbers>
 #include <algorithm>
+#include <bit>
+#include <cassert>
 #include <numeric>
+#include <memory>
+#include <unordered_map>
 
 namespace fourier {
 
@@ -11,141 +15,155 @@ namespace {
 
 using namespace utils;
 
-int upper_log2(const int x) {
-    constexpr int upperBound{ 30 };
-    for (int i = 0; i < upperBound; ++i) {
-        const int temp = 1 << i;
-        if (temp >= x)
-            return i;
-    }
-    return upperBound;
-}
-
-const std::vector<complex> phase_vec(const int len)
+// One plan per size and instruction set for each thread.
+template<typename Plan>
+Plan& cached_plan(const size_t size, const SimdLevel simd = best_simd_level())
 {
-    constexpr float radius{ 1.f };
-    std::vector<complex> res(len);
-    std::generate(res.begin(), res.end(), [&, i=0]() mutable{
-        const float phase = -2.f * pi * i++ / len;
-        return std::polar(radius, phase);
-    });
+    thread_local std::unordered_map<size_t, std::unique_ptr<Plan>> plans[static_cast<size_t>(SimdLevel::NEON) + 1];
 
-    return res;
-}
+    auto& plan = plans[static_cast<size_t>(simd)][size];
+    if (!plan)
+        plan = std::make_unique<Plan>(size, simd);
 
-void forward(std::vector<complex> &prev, std::vector<complex> &temp,
-             const std::vector<complex> &phases, const int turn, const int n_bits)
-{
-    if (turn == n_bits)
-        return;
-
-    const int group_size = 1 << (turn + 1);
-    const int num_groups = prev.size() / group_size;
-    const int phase_angular_freq = num_groups;
-    for (int i_group = 0; i_group < num_groups; ++i_group)
-    {
-        const int base_index = i_group * group_size;
-        for (int j = 0; j < group_size / 2; ++j)
-        {
-            const int x0_index = base_index + j;
-            const int x1_index = base_index + group_size / 2 + j;
-            prev[x1_index] *= phases[j * phase_angular_freq];
-            temp[x0_index] = prev[x0_index] + prev[x1_index];
-            temp[x1_index] = prev[x0_index] - prev[x1_index];
-        }
-    }
+    return *plan;
 }
 
-void bit_reversal_permutation(std::vector<complex> &vec, const int n_bits)
+// Chirp-z transform: out[m] = sum(x[n] * exp(i * n * (start + m * step))).
+// With n * m = (n^2 + m^2 - (m - n)^2) / 2 the sum becomes a convolution with
+// exp(-i * step * d^2 / 2), evaluated with one cached power-of-two plan.
+template<typename T>
+std::vector<complex> chirp_z(std::span<const T> input, const size_t outputs, const double start, const double step)
 {
-    if (vec.size() <= 2)
-        return;
+    const size_t N = input.size();
+    const size_t length = std::bit_ceil(std::max<size_t>(N, 1) + outputs - 1);
+    auto& plan = cached_plan<FftPlan>(length);
+
+    const auto chirp = [step](const size_t n) {
+        const double phase = step * static_cast<double>(n) * static_cast<double>(n) / 2;
+        return std::polar(1.0, phase);
+    };
+
+    std::vector<complex> signal(length);
+    for (size_t n = 0; n < N; ++n) {
+        const auto weight = chirp(n) * std::polar(1.0, start * static_cast<double>(n));
+        signal[n] = complex(input[n]) * complex(weight);
+    }
 
-    if (vec.size() == 4)
-    {
-        std::swap(vec[1], vec[3]);
-        return;
+    std::vector<complex> kernel(length);
+    for (size_t d = 0; d < std::max(N, outputs); ++d) {
+        const auto value = complex(std::conj(chirp(d)));
+        if (d < outputs)
+            kernel[d] = value;
+        if (d > 0 && d < N)
+            kernel[length - d] = value;
     }
 
-    std::vector<int> bit_rerversal(vec.size());
-
-    bit_rerversal[0] = 0;
-    bit_rerversal[1] = 1 << (n_bits - 1);
-    bit_rerversal[2] = 1 << (n_bits - 2);
-    bit_rerversal[3] = bit_rerversal[1] + bit_rerversal[2];
-
-    for (int k = 3; k <= n_bits; ++k)
-    {
-        const int nk = (1 << k) - 1;
-        const int n_km1 = (1 << (k - 1)) - 1;
-        bit_rerversal[nk] = bit_rerversal[n_km1] + (1 << (n_bits - k));
-        for (int i = 1; i <= n_km1; ++i)
-        {
-            bit_rerversal[nk - i] = bit_rerversal[nk] - bit_rerversal[i];
-        }
+    plan.execute(signal);
+    plan.execute(kernel);
+    for (size_t k = 0; k < length; ++k) {
+        signal[k] *= kernel[k];
     }
+    plan.executeInverse(signal);
 
-    for (size_t i = 0; i < vec.size(); ++i)
-    {
-        if (bit_rerversal[i] > i)
-            std::swap(vec[i], vec[bit_rerversal[i]]);
+    const auto scale = 1.0 / static_cast<double>(length);
+    std::vector<complex> output(outputs);
+    for (size_t m = 0; m < outputs; ++m) {
+        output[m] = signal[m] * complex(chirp(m) * scale);
     }
+
+    return output;
 }
 
-std::vector<complex> fft_impl(std::span<const complex> inputs)
+size_t spectrum_size(const RealFftPlan& plan) { return plan.bins(); }
+size_t spectrum_size(const FftPlan& plan) { return plan.size(); }
+
+[[maybe_unused]] bool fits(const size_t available, const size_t size, const Batch& batch)
 {
-    if (inputs.empty())
-    {
-        return {};
-    }
-    const int n_bits = upper_log2(inputs.size());
-    const int len = 1 << n_bits;
-    const std::vector<complex> phases = phase_vec(len);
-    std::vector<complex> prev(len);
-    std::vector<complex> temp(len);
-    std::copy(inputs.begin(), inputs.end(), prev.begin());
-    bit_reversal_permutation(prev, n_bits);
-    for (int turn = 0; turn < n_bits; ++turn){
-        forward(prev, temp, phases, turn, n_bits);
-        std::swap(prev, temp);
-    }
-    return prev;
+    return batch.count == 0 || size == 0
+        || (batch.count - 1) * batch.distance + (size - 1) * batch.stride < available;
 }
 
-std::vector<complex> ifft_impl(std::span<const complex> inputs)
+// Plans keep per-call scratch buffers, so each chunk of consecutive signals
+// runs on its thread's cached plan of the same size and instruction set;
+// tables are built once per thread, not per call.
+template<typename Plan, typename Body>
+void for_each_chunk(const Plan& plan, const Batch& batch, utils::ThreadPool& pool, const Body& body)
 {
-    std::vector<complex> reverse_freq_spectrum(inputs.begin(), inputs.end());
-    std::reverse(std::next(reverse_freq_spectrum.begin()), reverse_freq_spectrum.end());
-    return fft_impl(reverse_freq_spectrum);
+    const size_t chunks = std::min(batch.count, pool.concurrency());
+    pool.parallelFor(chunks, [&](const size_t chunk) {
+        auto& local = cached_plan<Plan>(plan.size(), plan.simdLevel());
+        body(local, chunk * batch.count / chunks, (chunk + 1) * batch.count / chunks);
+    });
 }
 
-} // namespace
+template<typename Plan, typename Sample>
+void forward_many(const Plan& plan, std::span<const Sample> input, const Batch& batch,
+                  std::span<complex> output, utils::ThreadPool& pool)
+{
+    const size_t size = plan.size();
+    const size_t bins = spectrum_size(plan);
+    assert(fits(input.size(), size, batch));
+    assert(output.size() >= batch.count * bins);
 
-std::vector<complex> dft(std::span<const float> input, float sampleRate) {
-    const size_t N = input.size();
-    std::vector<complex> output(kBufferSize, complex{});
+    for_each_chunk(plan, batch, pool, [&](Plan& local, const size_t first, const size_t last) {
+        thread_local std::vector<Sample> samples;
+        samples.resize(size);
+        for (size_t c = first; c < last; ++c) {
+            const Sample *signal = input.data() + c * batch.distance;
+            for (size_t n = 0; n < size; ++n) {
+                samples[n] = signal[n * batch.stride];
+            }
+            local.execute(samples, output.subspan(c * bins, bins));
+        }
+    });
+}
+
+template<typename Plan, typename Sample>
+void inverse_many(const Plan& plan, std::span<const complex> input, std::span<Sample> output,
+                  const Batch& batch, utils::ThreadPool& pool)
+{
+    const size_t size = plan.size();
+    const size_t bins = spectrum_size(plan);
+    assert(input.size() >= batch.count * bins);
+    assert(fits(output.size(), size, batch));
 
-    for (int k = kMinFrequency; k <= kMaxFrequency; ++k) {
-        complex sum(0, 0);
-        for (size_t n = 0; n < N; ++n) {
-            const float angle = -2.f * pi * k * n / sampleRate;
-            sum += input[n] * complex(std::cos(angle), std::sin(angle));
+    const float scale = 1.f / static_cast<float>(size);
+    for_each_chunk(plan, batch, pool, [&](Plan& local, const size_t first, const size_t last) {
+        thread_local std::vector<Sample> samples;
+        samples.resize(size);
+        for (size_t c = first; c < last; ++c) {
+            local.executeInverse(input.subspan(c * bins, bins), samples);
+            Sample *signal = output.data() + c * batch.distance;
+            for (size_t n = 0; n < size; ++n) {
+                signal[n * batch.stride] = samples[n] * scale;
+            }
         }
-        output[k - kMinFrequency] = sum;
-    }
+    });
+}
 
-    return output;
+} // namespace
+
+std::vector<complex> dft(std::span<const float> input, float sampleRate) {
+    if (input.empty())
+        return std::vector<complex>(kBufferSize, complex{});
+
+    const double step = -2.0 * std::numbers::pi / sampleRate;
+    return chirp_z(input, kBufferSize, step * kMinFrequency, step);
 }
 
 std::vector<float> idft(std::span<const complex> input, const size_t N, float sampleRate) {
+    if (N == 0)
+        return {};
+
+    // Bins from kMinFrequency up to, but not including, kMaxFrequency.
+    const auto bins = input.first(std::min<size_t>(input.size(), kBufferSize - 1));
+    const double step = 2.0 * std::numbers::pi / sampleRate;
+    const auto sums = chirp_z(bins, N, 0.0, step);
+
     std::vector<float> output(N);
     for (size_t n = 0; n < N; ++n) {
-        complex sum{};
-        for (int k = kMinFrequency; k < kMaxFrequency; ++k) {
-            const float angle = 2.f * pi * k * n / sampleRate;
-            sum += input[k - kMinFrequency] * complex(std::cos(angle), std::sin(angle));
-        }
-        output[n] = sum.real() / N;
+        const auto shift = std::polar(1.0, step * kMinFrequency * static_cast<double>(n));
+        output[n] = (sums[n] * complex(shift)).real() / N;
     }
     return output;
 }
@@ -157,20 +175,72 @@ std::vector<float> dft_freqs() {
 }
 
 std::vector<complex> fft(std::span<const float> inputs) {
-    std::vector<complex> data;
-    std::ranges::transform(inputs, std::back_inserter(data), [](const auto& num) {
-        return std::complex(num, 0.f);
-    });
+    if (inputs.empty())
+        return {};
+
+    auto& plan = cached_plan<RealFftPlan>(inputs.size());
+    const size_t N = plan.size();
+    std::vector<complex> data(N);
+    plan.execute(inputs, data);
+
+    for (size_t i = plan.bins(); i < N; ++i) {
+        data[i] = std::conj(data[N - i]);
+    }
 
-    return fft_impl(data);
+    return data;
 }
 
 std::vector<float> ifft(std::span<const complex> inputs) {
+    if (inputs.empty())
+        return {};
+
     const int N = inputs.size();
-	const auto data = ifft_impl(inputs);
-    std::vector<float> result;
-    std::ranges::transform(data, std::back_inserter(result), [N](const auto& num) {
-        return num.real() / N;
+    auto& plan = cached_plan<RealFftPlan>(inputs.size());
+
+    // Only the real part is kept, which is the inverse of the Hermitian part
+    // of the spectrum, so the half-length real transform gives the same result.
+    const auto bin = [&](const size_t i) {
+        return i < inputs.size() ? inputs[i] : complex{};
+    };
+    std::vector<complex> half(plan.bins());
+    for (size_t i = 0; i < half.size(); ++i) {
+        half[i] = 0.5f * (bin(i) + std::conj(bin((N - i) % N)));
+    }
+
+    std::vector<float> result(N);
+    plan.executeInverse(half, result);
+    std::ranges::transform(result, result.begin(), [N](const auto& num) {
+        return num / N;
+    });
+
+    return result;
+}
+
+std::vector<complex> rfft(std::span<const float> inputs) {
+    if (inputs.empty())
+        return {};
+
+    auto& plan = cached_plan<RealFftPlan>(inputs.size());
+    std::vector<complex> result(plan.bins());
+    plan.execute(inputs, result);
+
+    return result;
+}
+
+std::vector<float> irfft(std::span<const complex> inputs, const size_t N) {
+    if (inputs.empty() || N == 0)
+        return {};
+
+    auto& plan = cached_plan<RealFftPlan>(N);
+    std::vector<complex> spectrum(plan.bins());
+    std::copy_n(inputs.begin(), std::min(inputs.size(), spectrum.size()), spectrum.begin());
+
+    std::vector<float> result(plan.size());
+    plan.executeInverse(spectrum, result);
+
+    const auto scale = static_cast<float>(plan.size());
+    std::ranges::transform(result, result.begin(), [scale](const auto& num) {
+        return num / scale;
     });
 
     return result;
@@ -188,5 +258,36 @@ std::vector<float> fft_freqs(size_t N, float sampleRate) {
     return freqs;
 }
 
+std::vector<float> rfft_freqs(size_t N, float sampleRate) {
+    std::vector<float> freqs(N / 2 + 1);
+    for (size_t i = 0; i < freqs.size(); ++i) {
+        freqs[i] = static_cast<float>(i) * sampleRate / N;
+    }
+    return freqs;
+}
+
+void fft_many(const RealFftPlan& plan, std::span<const float> input, const Batch& batch,
+              std::span<complex> output, utils::ThreadPool& pool)
+{
+    forward_many(plan, input, batch, output, pool);
+}
+
+void ifft_many(const RealFftPlan& plan, std::span<const complex> input, std::span<float> output,
+               const Batch& batch, utils::ThreadPool& pool)
+{
+    inverse_many(plan, input, output, batch, pool);
+}
+
+void fft_many(const FftPlan& plan, std::span<const complex> input, const Batch& batch,
+              std::span<complex> output, utils::ThreadPool& pool)
+{
+    forward_many(plan, input, batch, output, pool);
+}
+
+void ifft_many(const FftPlan& plan, std::span<const complex> input, std::span<complex> output,
+               const Batch& batch, utils::ThreadPool& pool)
+{
+    inverse_many(plan, input, output, batch, pool);
+}
 
-} // namespace fourier
\ No newline at end of file
+} // namespace fourier
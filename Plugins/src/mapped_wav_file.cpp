@@ -0,0 +1,129 @@
+#include "mapped_wav_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// madvise needs a page-aligned start.
+void advise(const void *base, const size_t length, const size_t offset, const size_t size, const int advice)
+{
+    static const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    const size_t begin = offset / pageSize * pageSize;
+    const size_t end = std::min(offset + size, length);
+    if (end <= begin)
+        return;
+
+    auto *start = const_cast<unsigned char *>(static_cast<const unsigned char *>(base)) + begin;
+    madvise(start, end - begin, advice);
+}
+
+} // namespace
+
+MappedWavFile::~MappedWavFile()
+{
+    close();
+}
+
+MappedWavFile::MappedWavFile(MappedWavFile&& other) noexcept
+: m_mapping(std::exchange(other.m_mapping, nullptr))
+, m_length(std::exchange(other.m_length, 0))
+, m_bytes(std::exchange(other.m_bytes, {}))
+, m_format(other.m_format)
+{}
+
+MappedWavFile& MappedWavFile::operator=(MappedWavFile&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+        m_length = std::exchange(other.m_length, 0);
+        m_bytes = std::exchange(other.m_bytes, {});
+        m_format = other.m_format;
+    }
+    return *this;
+}
+
+bool MappedWavFile::open(const std::string& filename)
+{
+    close();
+
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open file " << filename << std::endl;
+        return false;
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        std::cerr << "Invalid WAV file " << filename << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    const auto length = static_cast<size_t>(info.st_size);
+    void *mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Failed to map file " << filename << std::endl;
+        return false;
+    }
+
+    m_mapping = mapping;
+    m_length = length;
+
+    const auto *bytes = static_cast<const unsigned char *>(mapping);
+    WavLayout layout;
+    if (!parse_wav(std::span(bytes, length), layout)) {
+        std::cerr << "Unsupported or invalid WAV file " << filename << std::endl;
+        close();
+        return false;
+    }
+
+    m_format = layout.format;
+    m_bytes = {bytes + layout.dataOffset, static_cast<size_t>(layout.dataSize)};
+    advise(m_mapping, m_length, layout.dataOffset, m_bytes.size(), MADV_SEQUENTIAL);
+
+    return true;
+}
+
+void MappedWavFile::close() noexcept
+{
+    if (m_mapping)
+        munmap(m_mapping, m_length);
+
+    m_mapping = nullptr;
+    m_length = 0;
+    m_bytes = {};
+    m_format = {};
+}
+
+size_t MappedWavFile::read(const size_t firstFrame, std::span<float> out) const
+{
+    if (firstFrame >= frames())
+        return 0;
+
+    const size_t count = std::min(out.size() / channels(), frames() - firstFrame);
+    decode_samples(m_bytes.data() + firstFrame * m_format.frameBytes(), m_format.sampleFormat,
+                   out.first(count * channels()));
+
+    return count;
+}
+
+void MappedWavFile::prefetch(const size_t firstFrame, const size_t frames) const
+{
+    if (!isOpen())
+        return;
+
+    const auto *base = static_cast<const unsigned char *>(m_mapping);
+    const size_t offset = static_cast<size_t>(m_bytes.data() - base) + firstFrame * m_format.frameBytes();
+    advise(m_mapping, m_length, offset, frames * m_format.frameBytes(), MADV_WILLNEED);
+}
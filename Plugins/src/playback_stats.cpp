@@ -0,0 +1,117 @@
+#include "../include/playback_stats.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <sstream>
+
+namespace {
+
+void write_histogram(std::ostream& out, const DurationHistogram& histogram)
+{
+    using std::chrono::duration;
+    using Micros = duration<double, std::micro>;
+
+    out << "{\"count\":" << histogram.count
+        << ",\"total_us\":" << Micros(histogram.total).count()
+        << ",\"max_us\":" << Micros(histogram.max).count()
+        << ",\"p50_us\":" << histogram.percentile(0.5).count()
+        << ",\"p99_us\":" << histogram.percentile(0.99).count()
+        << ",\"buckets\":[";
+    for (size_t i = 0; i < histogram.counts.size(); ++i)
+        out << (i > 0 ? "," : "") << histogram.counts[i];
+    out << "]}";
+}
+
+} // namespace
+
+std::chrono::microseconds DurationHistogram::percentile(const double fraction) const noexcept
+{
+    if (count == 0)
+        return {};
+
+    const auto largest = std::chrono::ceil<std::chrono::microseconds>(max);
+    const auto target = static_cast<uint64_t>(std::ceil(std::clamp(fraction, 0.0, 1.0) * static_cast<double>(count)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i + 1 < kBuckets; ++i) {
+        seen += counts[i];
+        if (seen >= std::max<uint64_t>(target, 1))
+            return std::min(std::chrono::microseconds(int64_t{1} << i), largest);
+    }
+    return largest;
+}
+
+void DurationRecorder::record(const std::chrono::nanoseconds duration) noexcept
+{
+    const auto nanos = std::max<int64_t>(duration.count(), 0);
+    const auto micros = static_cast<uint64_t>(nanos / 1000);
+    const size_t bucket = std::min<size_t>(std::bit_width(micros), DurationHistogram::kBuckets - 1);
+
+    m_counts[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_total.fetch_add(nanos, std::memory_order_relaxed);
+    // Single writer, so no compare-exchange is needed.
+    if (nanos > m_max.load(std::memory_order_relaxed))
+        m_max.store(nanos, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_release);
+}
+
+void DurationRecorder::reset() noexcept
+{
+    for (auto& count : m_counts)
+        count.store(0, std::memory_order_relaxed);
+    m_total.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_release);
+}
+
+DurationHistogram DurationRecorder::snapshot() const noexcept
+{
+    DurationHistogram histogram;
+    histogram.count = m_count.load(std::memory_order_acquire);
+    for (size_t i = 0; i < m_counts.size(); ++i)
+        histogram.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+    histogram.total = std::chrono::nanoseconds(m_total.load(std::memory_order_relaxed));
+    histogram.max = std::chrono::nanoseconds(m_max.load(std::memory_order_relaxed));
+    return histogram;
+}
+
+void PlaybackCounters::recordWrite(const size_t frames, const std::chrono::nanoseconds blocked) noexcept
+{
+    m_frames.fetch_add(frames, std::memory_order_relaxed);
+    m_blocked.record(blocked);
+}
+
+void PlaybackCounters::reset() noexcept
+{
+    m_frames.store(0, std::memory_order_relaxed);
+    m_xruns.store(0, std::memory_order_relaxed);
+    m_delay.store(0, std::memory_order_relaxed);
+    m_blocked.reset();
+}
+
+void PlaybackCounters::collect(PlaybackStats& stats) const noexcept
+{
+    stats.framesWritten = m_frames.load(std::memory_order_relaxed);
+    stats.xruns = xruns();
+    stats.delayFrames = delay();
+    stats.blocked = m_blocked.snapshot();
+}
+
+std::string to_json(const PlaybackStats& stats)
+{
+    std::ostringstream out;
+    out << "{\"sample_rate\":" << stats.sampleRate
+        << ",\"period_frames\":" << stats.periodFrames
+        << ",\"buffer_frames\":" << stats.bufferFrames
+        << ",\"frames_written\":" << stats.framesWritten
+        << ",\"xruns\":" << stats.xruns
+        << ",\"delay_frames\":" << stats.delayFrames
+        << ",\"underruns\":" << stats.underruns
+        << ",\"capture_xruns\":" << stats.captureXruns
+        << ",\"blocked\":";
+    write_histogram(out, stats.blocked);
+    out << ",\"callback\":";
+    write_histogram(out, stats.callback);
+    out << "}";
+    return out.str();
+}
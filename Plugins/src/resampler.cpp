@@ -0,0 +1,275 @@
+#include "../include/resampler.h"
+#include "../include/filter.h"
+#include "../include/window.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <numeric>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RESAMPLE_HAVE_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define RESAMPLE_HAVE_NEON
+#endif
+
+namespace filter {
+
+namespace {
+
+// Taps are kept a multiple of the unrolled dot product width.
+constexpr size_t kTapAlign{ 8 };
+constexpr size_t kChunkFrames{ 1024 };
+
+struct QualitySpec {
+    float attenuationDb;
+    double passband;
+};
+
+QualitySpec quality_spec(const ResampleQuality quality) noexcept
+{
+    switch (quality) {
+        case ResampleQuality::LOW:
+            return {60.f, 0.80};
+        case ResampleQuality::HIGH:
+            return {120.f, 0.95};
+        case ResampleQuality::MEDIUM:
+            break;
+    }
+    return {90.f, 0.90};
+}
+
+float dot(const float *a, const float *b, const size_t size) noexcept
+{
+#if defined(RESAMPLE_HAVE_SSE2)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (size_t i = 0; i < size; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    acc0 = _mm_add_ps(acc0, acc1);
+    acc0 = _mm_add_ps(acc0, _mm_movehl_ps(acc0, acc0));
+    acc0 = _mm_add_ss(acc0, _mm_shuffle_ps(acc0, acc0, 1));
+    return _mm_cvtss_f32(acc0);
+#elif defined(RESAMPLE_HAVE_NEON)
+    float32x4_t acc0 = vdupq_n_f32(0.f);
+    float32x4_t acc1 = vdupq_n_f32(0.f);
+    for (size_t i = 0; i < size; i += 8) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    return vaddvq_f32(vaddq_f32(acc0, acc1));
+#else
+    float acc[kTapAlign]{};
+    for (size_t i = 0; i < size; i += kTapAlign)
+        for (size_t k = 0; k < kTapAlign; ++k)
+            acc[k] += a[i + k] * b[i + k];
+    return std::accumulate(acc, acc + kTapAlign, 0.f);
+#endif
+}
+
+// Two rows against the same history, for interpolated phases.
+void dot2(const float *a0, const float *a1, const float *b, const size_t size, float& out0, float& out1) noexcept
+{
+#if defined(RESAMPLE_HAVE_SSE2)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (size_t i = 0; i < size; i += 4) {
+        const __m128 x = _mm_loadu_ps(b + i);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a0 + i), x));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a1 + i), x));
+    }
+    acc0 = _mm_add_ps(acc0, _mm_movehl_ps(acc0, acc0));
+    acc0 = _mm_add_ss(acc0, _mm_shuffle_ps(acc0, acc0, 1));
+    acc1 = _mm_add_ps(acc1, _mm_movehl_ps(acc1, acc1));
+    acc1 = _mm_add_ss(acc1, _mm_shuffle_ps(acc1, acc1, 1));
+    out0 = _mm_cvtss_f32(acc0);
+    out1 = _mm_cvtss_f32(acc1);
+#elif defined(RESAMPLE_HAVE_NEON)
+    float32x4_t acc0 = vdupq_n_f32(0.f);
+    float32x4_t acc1 = vdupq_n_f32(0.f);
+    for (size_t i = 0; i < size; i += 4) {
+        const float32x4_t x = vld1q_f32(b + i);
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a0 + i), x);
+        acc1 = vfmaq_f32(acc1, vld1q_f32(a1 + i), x);
+    }
+    out0 = vaddvq_f32(acc0);
+    out1 = vaddvq_f32(acc1);
+#else
+    out0 = dot(a0, b, size);
+    out1 = dot(a1, b, size);
+#endif
+}
+
+} // namespace
+
+Resampler::Resampler(const unsigned int inputRate, const unsigned int outputRate, const size_t channels,
+                     const ResampleQuality quality)
+: m_inputRate(std::max(inputRate, 1u))
+, m_outputRate(std::max(outputRate, 1u))
+, m_channels(std::max<size_t>(channels, 1))
+{
+    const uint64_t divisor = std::gcd(m_inputRate, m_outputRate);
+    m_up = m_outputRate / divisor;
+    m_down = m_inputRate / divisor;
+    m_phases = static_cast<size_t>(std::min<uint64_t>(m_up, kMaxPhases));
+
+    // Cutoff and transition band scale with the lower of the two rates,
+    // in cycles per input sample.
+    const auto [attenuationDb, passband] = quality_spec(quality);
+    const double ratio = std::min(1.0, static_cast<double>(m_up) / static_cast<double>(m_down));
+    const double transition = 0.5 * (1.0 - passband) * ratio;
+    const double cutoff = 0.25 * (1.0 + passband) * ratio;
+
+    const auto taps = static_cast<size_t>(std::ceil((attenuationDb - 7.95) / (14.36 * transition)));
+    m_taps = (std::max<size_t>(taps, kTapAlign) + kTapAlign - 1) / kTapAlign * kTapAlign;
+
+    // Row r, tap j sits at t = j + 1 - taps / 2 - r / phases input samples
+    // from the output time, i.e. at index (j + 1) * phases - r of a prototype
+    // sampled phases times per input sample.
+    const size_t length = m_taps * m_phases + 1;
+    const auto window = utils::make_window(utils::WindowType::KAISER, length, false, kaiser_beta(attenuationDb));
+    const double centre = static_cast<double>(length - 1) / 2.0;
+
+    m_table.resize((m_phases + 1) * m_taps);
+    for (size_t row = 0; row <= m_phases; ++row) {
+        float *coefficients = m_table.data() + row * m_taps;
+        double sum = 0.0;
+        for (size_t j = 0; j < m_taps; ++j) {
+            const size_t index = (j + 1) * m_phases - row;
+            const double t = (static_cast<double>(index) - centre) / static_cast<double>(m_phases);
+            const double x = 2.0 * cutoff * t;
+            const double sinc = x == 0.0 ? 1.0 : std::sin(std::numbers::pi * x) / (std::numbers::pi * x);
+            const double value = 2.0 * cutoff * sinc * window[index];
+            coefficients[j] = static_cast<float>(value);
+            sum += value;
+        }
+        for (size_t j = 0; j < m_taps; ++j)
+            coefficients[j] = static_cast<float>(coefficients[j] / sum);
+    }
+
+    m_capacity = m_taps + kChunkFrames;
+    m_history.resize(m_channels * m_capacity);
+    reset();
+}
+
+void Resampler::reset()
+{
+    std::fill(m_history.begin(), m_history.end(), 0.f);
+    // Zeros before the first input centre the first window on it.
+    m_size = m_taps / 2 - 1;
+    m_index = 0;
+    m_phase = 0;
+    m_inputFrames = 0;
+    m_outputFrames = 0;
+}
+
+size_t Resampler::maxOutputFrames(const size_t inputFrames) const noexcept
+{
+    return static_cast<size_t>(((inputFrames + m_taps) * m_up + m_down - 1) / m_down) + 1;
+}
+
+size_t Resampler::process(std::span<const float> in, std::span<float> out)
+{
+    const size_t frames = in.size() / m_channels;
+    size_t written = 0;
+
+    for (size_t done = 0; done < frames;) {
+        const size_t count = std::min(frames - done, m_capacity - m_size);
+        for (size_t channel = 0; channel < m_channels; ++channel) {
+            float *history = m_history.data() + channel * m_capacity + m_size;
+            const float *source = in.data() + done * m_channels + channel;
+            for (size_t i = 0; i < count; ++i)
+                history[i] = source[i * m_channels];
+        }
+
+        m_size += count;
+        m_inputFrames += count;
+        done += count;
+        written += render(out.subspan(written * m_channels), UINT64_MAX);
+    }
+
+    return written;
+}
+
+size_t Resampler::flush(std::span<float> out)
+{
+    const uint64_t expected = (m_inputFrames * m_up + m_down - 1) / m_down;
+    size_t written = 0;
+
+    while (m_outputFrames < expected) {
+        for (size_t channel = 0; channel < m_channels; ++channel) {
+            float *history = m_history.data() + channel * m_capacity;
+            std::fill(history + m_size, history + m_capacity, 0.f);
+        }
+        m_size = m_capacity;
+        written += render(out.subspan(written * m_channels), expected - m_outputFrames);
+    }
+
+    reset();
+    return written;
+}
+
+size_t Resampler::render(std::span<float> out, const uint64_t limit)
+{
+    size_t frames = 0;
+    const bool exact = m_phases == m_up;
+
+    while (m_index + m_taps <= m_size && frames < limit) {
+        float *frame = out.data() + frames * m_channels;
+
+        if (exact) {
+            const float *row = m_table.data() + m_phase * m_taps;
+            for (size_t channel = 0; channel < m_channels; ++channel)
+                frame[channel] = dot(row, m_history.data() + channel * m_capacity + m_index, m_taps);
+        } else {
+            const uint64_t scaled = m_phase * m_phases;
+            const float *row = m_table.data() + (scaled / m_up) * m_taps;
+            const auto fraction = static_cast<float>(static_cast<double>(scaled % m_up) / static_cast<double>(m_up));
+            for (size_t channel = 0; channel < m_channels; ++channel) {
+                float first = 0.f;
+                float second = 0.f;
+                dot2(row, row + m_taps, m_history.data() + channel * m_capacity + m_index, m_taps, first, second);
+                frame[channel] = first + fraction * (second - first);
+            }
+        }
+
+        ++frames;
+        m_phase += m_down;
+        m_index += static_cast<size_t>(m_phase / m_up);
+        m_phase %= m_up;
+    }
+
+    // Keep what the next window still needs. When downsampling, m_index may
+    // point past the data received so far; the remainder carries over.
+    const size_t consumed = std::min(m_index, m_size);
+    if (consumed > 0) {
+        for (size_t channel = 0; channel < m_channels; ++channel) {
+            float *history = m_history.data() + channel * m_capacity;
+            std::copy(history + consumed, history + m_size, history);
+        }
+        m_size -= consumed;
+        m_index -= consumed;
+    }
+
+    m_outputFrames += frames;
+    return frames;
+}
+
+std::vector<float> resample(std::span<const float> input, const unsigned int inputRate, const unsigned int outputRate,
+                            const size_t channels, const ResampleQuality quality)
+{
+    Resampler resampler(inputRate, outputRate, channels, quality);
+    std::vector<float> output((resampler.maxOutputFrames(input.size() / resampler.channels())
+                               + resampler.maxOutputFrames(0)) * resampler.channels());
+
+    size_t frames = resampler.process(input, output);
+    frames += resampler.flush(std::span(output).subspan(frames * resampler.channels()));
+    output.resize(frames * resampler.channels());
+    return output;
+}
+
+} // namespace filter
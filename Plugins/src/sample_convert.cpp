@@ -0,0 +1,282 @@
+#include "sample_convert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CONVERT_HAVE_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define CONVERT_HAVE_NEON
+#endif
+
+namespace {
+
+constexpr float kScale16{ 32767.f };
+constexpr float kScale24{ 8388607.f };
+// 2^31 - 1 is not a float; saturate at the largest float below 2^31 instead.
+constexpr float kScale32{ 2147483647.f };
+constexpr float kLimit32{ 2147483520.f };
+
+constexpr size_t kBlockSize{ 256 };
+constexpr float kMaxShapedError{ 4.f };
+
+// Same operand order as minps/maxps, so NaN saturates like the vector path.
+float saturate(const float value, const float limit) noexcept
+{
+    const float low = value > -limit ? value : -limit;
+    return low < limit ? low : limit;
+}
+
+int32_t quantize(const float sample, const float scale, const float limit) noexcept
+{
+    return static_cast<int32_t>(std::lrint(saturate(sample * scale, limit)));
+}
+
+template<typename T>
+void store(void *destination, const T value) noexcept
+{
+    std::memcpy(destination, &value, sizeof(T));
+}
+
+template<typename T>
+T load(const void *source) noexcept
+{
+    T value;
+    std::memcpy(&value, source, sizeof(T));
+    return value;
+}
+
+float round_even(const float value) noexcept
+{
+#if defined(CONVERT_HAVE_SSE2)
+    return static_cast<float>(_mm_cvtss_si32(_mm_set_ss(value)));
+#else
+    return std::nearbyint(value);
+#endif
+}
+
+void quantize_block(const float *in, const size_t count, unsigned char *out,
+                    const float scale, const float limit) noexcept
+{
+    size_t i = 0;
+#if defined(CONVERT_HAVE_SSE2)
+    const __m128 vscale = _mm_set1_ps(scale);
+    const __m128 vhigh = _mm_set1_ps(limit);
+    const __m128 vlow = _mm_set1_ps(-limit);
+    for (; i + 4 <= count; i += 4) {
+        const __m128 x = _mm_mul_ps(_mm_loadu_ps(in + i), vscale);
+        const __m128i q = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(x, vlow), vhigh));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 4 * i), q);
+    }
+#elif defined(CONVERT_HAVE_NEON)
+    const float32x4_t vhigh = vdupq_n_f32(limit);
+    const float32x4_t vlow = vdupq_n_f32(-limit);
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t x = vmulq_n_f32(vld1q_f32(in + i), scale);
+        const int32x4_t q = vcvtnq_s32_f32(vminq_f32(vmaxq_f32(x, vlow), vhigh));
+        vst1q_u8(out + 4 * i, vreinterpretq_u8_s32(q));
+    }
+#endif
+    for (; i < count; ++i) {
+        store(out + 4 * i, quantize(in[i], scale, limit));
+    }
+}
+
+void dequantize_block(const unsigned char *in, const size_t count, float *out, const float scale) noexcept
+{
+    const float inverse = 1.f / scale;
+
+    size_t i = 0;
+#if defined(CONVERT_HAVE_SSE2)
+    const __m128 vinverse = _mm_set1_ps(inverse);
+    for (; i + 4 <= count; i += 4) {
+        const __m128i q = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 4 * i));
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(q), vinverse));
+    }
+#elif defined(CONVERT_HAVE_NEON)
+    for (; i + 4 <= count; i += 4) {
+        const int32x4_t q = vreinterpretq_s32_u8(vld1q_u8(in + 4 * i));
+        vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(q), inverse));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = static_cast<float>(load<int32_t>(in + 4 * i)) * inverse;
+    }
+}
+
+// Difference of two uniform variables: triangular on (-1, 1) LSB. Both come
+// from the high bits of one 64-bit LCG step, the part of its output with the
+// longest period, so the loop-carried work is a single multiply-add.
+float triangular(uint64_t& state) noexcept
+{
+    constexpr float kInverse = 1.f / 65536.f;
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    const auto a = static_cast<int32_t>((state >> 32) & 0xFFFF);
+    const auto b = static_cast<int32_t>(state >> 48);
+    return static_cast<float>(a - b) * kInverse;
+}
+
+} // namespace
+
+void float_to_int16(std::span<const float> in, int16_t *out) noexcept
+{
+    auto *bytes = reinterpret_cast<unsigned char *>(out);
+    const float *src = in.data();
+    const size_t count = in.size();
+
+    size_t i = 0;
+#if defined(CONVERT_HAVE_SSE2)
+    const __m128 vscale = _mm_set1_ps(kScale16);
+    const __m128 vhigh = _mm_set1_ps(kScale16);
+    const __m128 vlow = _mm_set1_ps(-kScale16);
+    for (; i + 8 <= count; i += 8) {
+        const __m128 a = _mm_mul_ps(_mm_loadu_ps(src + i), vscale);
+        const __m128 b = _mm_mul_ps(_mm_loadu_ps(src + i + 4), vscale);
+        const __m128i qa = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(a, vlow), vhigh));
+        const __m128i qb = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(b, vlow), vhigh));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(bytes + 2 * i), _mm_packs_epi32(qa, qb));
+    }
+#elif defined(CONVERT_HAVE_NEON)
+    const float32x4_t vhigh = vdupq_n_f32(kScale16);
+    const float32x4_t vlow = vdupq_n_f32(-kScale16);
+    for (; i + 8 <= count; i += 8) {
+        const float32x4_t a = vmulq_n_f32(vld1q_f32(src + i), kScale16);
+        const float32x4_t b = vmulq_n_f32(vld1q_f32(src + i + 4), kScale16);
+        const int32x4_t qa = vcvtnq_s32_f32(vminq_f32(vmaxq_f32(a, vlow), vhigh));
+        const int32x4_t qb = vcvtnq_s32_f32(vminq_f32(vmaxq_f32(b, vlow), vhigh));
+        vst1q_u8(bytes + 2 * i, vreinterpretq_u8_s16(vcombine_s16(vqmovn_s32(qa), vqmovn_s32(qb))));
+    }
+#endif
+    for (; i < count; ++i) {
+        store(bytes + 2 * i, static_cast<int16_t>(quantize(src[i], kScale16, kScale16)));
+    }
+}
+
+void float_to_int24(std::span<const float> in, unsigned char *out) noexcept
+{
+    unsigned char block[4 * kBlockSize];
+    for (size_t offset = 0; offset < in.size(); offset += kBlockSize) {
+        const size_t count = std::min(kBlockSize, in.size() - offset);
+        quantize_block(in.data() + offset, count, block, kScale24, kScale24);
+
+        unsigned char *dst = out + 3 * offset;
+        for (size_t i = 0; i < count; ++i) {
+            dst[3 * i] = block[4 * i];
+            dst[3 * i + 1] = block[4 * i + 1];
+            dst[3 * i + 2] = block[4 * i + 2];
+        }
+    }
+}
+
+void float_to_int32(std::span<const float> in, int32_t *out) noexcept
+{
+    quantize_block(in.data(), in.size(), reinterpret_cast<unsigned char *>(out), kScale32, kLimit32);
+}
+
+void int16_to_float(const int16_t *in, std::span<float> out) noexcept
+{
+    const auto *bytes = reinterpret_cast<const unsigned char *>(in);
+    constexpr float inverse = 1.f / kScale16;
+    float *dst = out.data();
+    const size_t count = out.size();
+
+    size_t i = 0;
+#if defined(CONVERT_HAVE_SSE2)
+    const __m128 vinverse = _mm_set1_ps(inverse);
+    for (; i + 8 <= count; i += 8) {
+        const __m128i q = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + 2 * i));
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(q, q), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(q, q), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), vinverse));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), vinverse));
+    }
+#elif defined(CONVERT_HAVE_NEON)
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t q = vreinterpretq_s16_u8(vld1q_u8(bytes + 2 * i));
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(q))), inverse));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(q))), inverse));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = static_cast<float>(load<int16_t>(bytes + 2 * i)) * inverse;
+    }
+}
+
+void int24_to_float(const unsigned char *in, std::span<float> out) noexcept
+{
+    unsigned char block[4 * kBlockSize];
+    for (size_t offset = 0; offset < out.size(); offset += kBlockSize) {
+        const size_t count = std::min(kBlockSize, out.size() - offset);
+
+        const unsigned char *src = in + 3 * offset;
+        for (size_t i = 0; i < count; ++i) {
+            const auto value = static_cast<int32_t>(static_cast<uint32_t>(src[3 * i]) << 8
+                                                  | static_cast<uint32_t>(src[3 * i + 1]) << 16
+                                                  | static_cast<uint32_t>(src[3 * i + 2]) << 24) >> 8;
+            store(block + 4 * i, value);
+        }
+        dequantize_block(block, count, out.data() + offset, kScale24);
+    }
+}
+
+void int32_to_float(const int32_t *in, std::span<float> out) noexcept
+{
+    dequantize_block(reinterpret_cast<const unsigned char *>(in), out.size(), out.data(), kScale32);
+}
+
+Ditherer::Ditherer(const unsigned int channels, const unsigned int bits, const DitherType type,
+                   const uint32_t seed) noexcept
+: m_error(2 * std::max(channels, 1u), 0.f)
+, m_type(type)
+, m_channels(std::max(channels, 1u))
+, m_bits(bits)
+, m_scale(static_cast<float>((1u << (std::clamp(bits, 2u, 24u) - 1)) - 1))
+, m_seed(seed)
+, m_state(m_seed)
+{}
+
+void Ditherer::reset() noexcept
+{
+    std::ranges::fill(m_error, 0.f);
+    m_state = m_seed;
+    m_channel = 0;
+}
+
+// Formats wider than 24 bits have a finer grid than float can hold; those
+// samples are left for the converter to round.
+void Ditherer::process(std::span<float> samples) noexcept
+{
+    if (m_type == DitherType::NONE || m_bits > 24)
+        return;
+
+    uint64_t state = m_state;
+    size_t channel = m_channel;
+
+    if (m_type == DitherType::TPDF) {
+        for (float& sample : samples) {
+            const float target = saturate(sample, 1.f) * m_scale;
+            const float level = std::clamp(round_even(target + triangular(state)), -m_scale, m_scale);
+            sample = level / m_scale;
+        }
+        channel = (channel + samples.size()) % m_channels;
+    } else {
+        for (float& sample : samples) {
+            float *error = m_error.data() + 2 * channel;
+
+            const float target = saturate(sample, 1.f) * m_scale - (2.f * error[0] - error[1]);
+            const float level = std::clamp(round_even(target + triangular(state)), -m_scale, m_scale);
+            error[1] = error[0];
+            error[0] = std::clamp(level - target, -kMaxShapedError, kMaxShapedError);
+
+            sample = level / m_scale;
+            if (++channel == m_channels)
+                channel = 0;
+        }
+    }
+
+    m_state = state;
+    m_channel = channel;
+}
@@ -0,0 +1,108 @@
+#include "stft.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+
+// Smallest summed squared window the overlap-add may divide by.
+constexpr float kMinWindowSum{1e-6f};
+
+} // namespace
+
+namespace fourier {
+
+Stft::Stft(const size_t frameSize, const size_t hop, const utils::WindowType window, const float kaiserBeta)
+: m_frameSize(std::max<size_t>(frameSize, 1))
+, m_hop(std::clamp<size_t>(hop, 1, m_frameSize))
+, m_plan(m_frameSize)
+, m_window(utils::make_window(window, m_frameSize, true, kaiserBeta))
+, m_norm(m_hop)
+, m_frame(m_frameSize)
+, m_spectrum(m_plan.bins())
+{
+    assert(frameSize >= 1 && hop >= 1 && hop <= frameSize);
+
+    // Every output sample at offset j within a hop is covered by the frames
+    // that see it at offsets j, j + hop, j + 2 * hop, ...
+    for (size_t j = 0; j < m_hop; ++j) {
+        float sum = 0.f;
+        for (size_t n = j; n < m_frameSize; n += m_hop) {
+            sum += m_window[n] * m_window[n];
+        }
+        assert(sum > kMinWindowSum);
+        m_norm[j] = 1.f / std::max(sum, kMinWindowSum);
+    }
+
+    reset();
+}
+
+void Stft::reset()
+{
+    // Frames start latency() samples before the stream so that the first
+    // output samples are covered by as many frames as the later ones.
+    m_input.assign(m_frameSize, 0.f);
+    m_overlap.assign(m_frameSize, 0.f);
+    m_filled = latency();
+    m_skip = latency();
+    m_pending = 0;
+}
+
+void Stft::push(std::span<const float> input, std::vector<float>& output)
+{
+    while (!input.empty()) {
+        const size_t count = std::min(input.size(), m_frameSize - m_filled);
+        std::copy_n(input.begin(), count, m_input.begin() + static_cast<std::ptrdiff_t>(m_filled));
+        m_filled += count;
+        m_pending += count;
+        input = input.subspan(count);
+
+        if (m_filled == m_frameSize)
+            processFrame(output);
+    }
+}
+
+void Stft::flush(std::vector<float>& output)
+{
+    while (m_pending > 0) {
+        std::fill(m_input.begin() + static_cast<std::ptrdiff_t>(m_filled), m_input.end(), 0.f);
+        m_filled = m_frameSize;
+        processFrame(output);
+    }
+
+    reset();
+}
+
+void Stft::processFrame(std::vector<float>& output)
+{
+    for (size_t n = 0; n < m_frameSize; ++n) {
+        m_frame[n] = m_input[n] * m_window[n];
+    }
+
+    m_plan.execute(m_frame, m_spectrum);
+    if (m_processor)
+        m_processor(m_spectrum);
+    m_plan.executeInverse(m_spectrum, m_frame);
+
+    const float scale = 1.f / static_cast<float>(m_frameSize);
+    for (size_t n = 0; n < m_frameSize; ++n) {
+        m_overlap[n] += m_frame[n] * m_window[n] * scale;
+    }
+
+    for (size_t j = 0; j < m_hop; ++j) {
+        if (m_skip > 0) {
+            --m_skip;
+        } else if (m_pending > 0) {
+            output.push_back(m_overlap[j] * m_norm[j]);
+            --m_pending;
+        }
+    }
+
+    const auto hop = static_cast<std::ptrdiff_t>(m_hop);
+    std::copy(m_overlap.begin() + hop, m_overlap.end(), m_overlap.begin());
+    std::fill(m_overlap.end() - hop, m_overlap.end(), 0.f);
+    std::copy(m_input.begin() + hop, m_input.end(), m_input.begin());
+    m_filled = latency();
+}
+
+} // namespace fourier
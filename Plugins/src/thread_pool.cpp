@@ -0,0 +1,89 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace utils {
+
+ThreadPool::ThreadPool(const size_t threads)
+{
+    const size_t workers = std::max<size_t>(threads, 1) - 1;
+    m_workers.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::global()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::parallelFor(const size_t count, const std::function<void(size_t)>& task)
+{
+    if (m_workers.empty() || count < 2) {
+        for (size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    std::lock_guard submit(m_submitMutex);
+    {
+        std::lock_guard lock(m_mutex);
+        m_task = &task;
+        m_count = count;
+        m_next = 0;
+        m_active = m_workers.size();
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    runTasks();
+
+    std::unique_lock lock(m_mutex);
+    m_done.wait(lock, [this] { return m_active == 0; });
+    m_task = nullptr;
+}
+
+void ThreadPool::runTasks()
+{
+    for (size_t i = m_next++; i < m_count; i = m_next++) {
+        (*m_task)(i);
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    size_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stopping || m_generation != seen; });
+            if (m_stopping)
+                return;
+            seen = m_generation;
+        }
+
+        runTasks();
+
+        std::lock_guard lock(m_mutex);
+        if (--m_active == 0)
+            m_done.notify_one();
+    }
+}
+
+} // namespace utils
@@ -5,30 +5,9 @@
 #include <fstream>
 #include <iostream>
 
-namespace {
-
-#pragma pack(push, 1)
-    struct WavHeader {
-        char riff[4];
-        uint32_t chunk_size;
-        char wave[4];
-        char fmt[4];
-        uint32_t subchunk1_size;
-        uint16_t audio_format;
-        uint16_t num_channels;
-        uint32_t sample_rate;
-        uint32_t byte_rate;
-        uint16_t block_align;
-        uint16_t bits_per_sample;
-        char data[4];
-        uint32_t data_size;
-    };
-#pragma pack(pop)
-
-}
-
-WavFile::WavFile(unsigned int sampleRate, unsigned int channels) noexcept
-: m_channels(channels), m_sampleRate(sampleRate)
+WavFile::WavFile(unsigned int sampleRate, unsigned int channels, SampleFormat format) noexcept
+: m_format{format, channels, sampleRate}
+, m_ditherer(channels, 8 * bytes_per_sample(format), DitherType::NONE)
 {}
 
 void WavFile::clear() {
@@ -36,19 +15,26 @@ void WavFile::clear() {
 }
 
 void WavFile::append(const std::span<const float>& data) {
-    constexpr float multiplier{ 32767.f };
-    std::ranges::transform(data, std::back_inserter(m_buffer), [](const auto& sample) {
-        return static_cast<int16_t>(sample * multiplier);
-    });
+    const size_t offset = m_buffer.size();
+    m_buffer.resize(offset + data.size() * bytes_per_sample(m_format.sampleFormat));
+
+    if (m_ditherer.type() == DitherType::NONE || m_format.sampleFormat == SampleFormat::FLOAT32) {
+        encode_samples(data, m_format.sampleFormat, m_buffer.data() + offset);
+        return;
+    }
+
+    m_scratch.assign(data.begin(), data.end());
+    m_ditherer.process(m_scratch);
+    encode_samples(m_scratch, m_format.sampleFormat, m_buffer.data() + offset);
 }
 
-std::vector<float> WavFile::data() const {
-    constexpr float divider{ 32767.f };
+void WavFile::setDither(const DitherType type) {
+    m_ditherer = Ditherer(m_format.channels, 8 * bytes_per_sample(m_format.sampleFormat), type);
+}
 
-    std::vector<float> data(m_buffer.size());
-    std::ranges::transform(m_buffer, data.begin(), [](const auto& sample) {
-        return static_cast<float>(sample) / divider;
-    });
+std::vector<float> WavFile::data() const {
+    std::vector<float> data(m_buffer.size() / bytes_per_sample(m_format.sampleFormat));
+    decode_samples(m_buffer.data(), m_format.sampleFormat, data);
 
     return data;
 }
@@ -61,45 +47,46 @@ bool WavFile::save(const std::string& filename) const
         return false;
     }
 
-    constexpr uint16_t BITS_PER_SAMPLE = 16;
-    constexpr uint16_t PCM_FORMAT = 1;
-
-    const auto frame_count = static_cast<uint32_t>(m_buffer.size());
-    const uint32_t data_length = frame_count * sizeof(int16_t);
-
-    WavHeader header{};
-    std::memcpy(header.riff, "RIFF", 4);
-    header.chunk_size = data_length + sizeof(WavHeader) - 8;
-    std::memcpy(header.wave, "WAVE", 4);
-    std::memcpy(header.fmt, "fmt ", 4);
-    header.subchunk1_size = 16;
-    header.audio_format = PCM_FORMAT;
-    header.num_channels = static_cast<uint16_t>(m_channels);
-    header.sample_rate = m_sampleRate;
-    header.byte_rate = m_sampleRate * m_channels * sizeof(int16_t);
-    header.block_align = static_cast<uint16_t>(m_channels * sizeof(int16_t));
-    header.bits_per_sample = BITS_PER_SAMPLE;
-    std::memcpy(header.data, "data", 4);
-    header.data_size = data_length;
-
-    file.write(reinterpret_cast<const char *>(&header), sizeof(decltype(header)));
-    file.write(reinterpret_cast<const char *>(m_buffer.data()), data_length);
+    const auto header = make_wav_header(m_format, m_buffer.size());
+    file.write(header.data(), static_cast<std::streamsize>(header.size()));
+    file.write(reinterpret_cast<const char *>(m_buffer.data()), static_cast<std::streamsize>(m_buffer.size()));
+    if (m_buffer.size() % 2)
+        file.put(0);
 
-    return true;
+    return static_cast<bool>(file);
+}
+
+void WavFile::resample(const unsigned int sampleRate, const filter::ResampleQuality quality) {
+    if (sampleRate == 0 || sampleRate == m_format.sampleRate)
+        return;
+
+    const auto samples = filter::resample(data(), m_format.sampleRate, sampleRate, m_format.channels, quality);
+    m_format.sampleRate = sampleRate;
+    clear();
+    append(samples);
 }
 
-bool WavFile::load(const std::string& filename) {
+bool WavFile::load(const std::string& filename, const unsigned int sampleRate, const filter::ResampleQuality quality) {
     std::ifstream file(filename, std::ios::in | std::ios::binary);
     if (!file.is_open()) {
         std::cerr << "Failed to open file " << filename << std::endl;
         return false;
     }
 
-    WavHeader header{};
-    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    WavLayout layout;
+    if (!parse_wav(file, layout)) {
+        std::cerr << "Unsupported or invalid WAV file " << filename << std::endl;
+        return false;
+    }
 
-    m_buffer.resize(header.data_size / sizeof(int16_t));
-    file.read(reinterpret_cast<char*>(m_buffer.data()), header.data_size);
+    m_format = layout.format;
+    setDither(m_ditherer.type());
+    m_buffer.resize(layout.dataSize);
+    file.seekg(static_cast<std::streamoff>(layout.dataOffset));
+    file.read(reinterpret_cast<char*>(m_buffer.data()), static_cast<std::streamsize>(m_buffer.size()));
+    if (!file)
+        return false;
 
+    resample(sampleRate, quality);
     return true;
 }
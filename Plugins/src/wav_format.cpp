@@ -0,0 +1,254 @@
+#include "wav_format.h"
+#include "sample_convert.h"
+
+#include <algorithm>
+#include <cstring>
+#include <istream>
+
+namespace {
+
+constexpr uint16_t kPcmTag{ 0x0001 };
+constexpr uint16_t kFloatTag{ 0x0003 };
+constexpr uint16_t kExtensibleTag{ 0xFFFE };
+constexpr uint32_t kUnknownSize{ 0xFFFFFFFF };
+
+constexpr size_t kChunkHeaderSize{ 8 };
+constexpr size_t kDs64Size{ 28 };
+constexpr size_t kPlainFormatSize{ 16 };
+constexpr size_t kExtensibleFormatSize{ 40 };
+
+// KSDATAFORMAT_SUBTYPE_PCM / _IEEE_FLOAT share everything but the first two bytes.
+constexpr unsigned char kSubformatTail[14]{
+    0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71
+};
+
+template<typename T>
+T load(const unsigned char *p)
+{
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+template<typename T>
+void put(std::vector<char>& bytes, const T value)
+{
+    const auto *raw = reinterpret_cast<const char *>(&value);
+    bytes.insert(bytes.end(), raw, raw + sizeof(T));
+}
+
+void put_id(std::vector<char>& bytes, const char *id)
+{
+    bytes.insert(bytes.end(), id, id + 4);
+}
+
+bool parse_format(const unsigned char *fmt, const size_t size, WavFormat& format)
+{
+    if (size < kPlainFormatSize)
+        return false;
+
+    uint16_t tag = load<uint16_t>(fmt);
+    const uint16_t channels = load<uint16_t>(fmt + 2);
+    const uint32_t sampleRate = load<uint32_t>(fmt + 4);
+    const uint16_t blockAlign = load<uint16_t>(fmt + 12);
+    const uint16_t bits = load<uint16_t>(fmt + 14);
+
+    if (tag == kExtensibleTag) {
+        if (size < kExtensibleFormatSize || std::memcmp(fmt + 26, kSubformatTail, sizeof(kSubformatTail)) != 0)
+            return false;
+        tag = load<uint16_t>(fmt + 24);
+    }
+
+    if (tag == kPcmTag && bits == 16)
+        format.sampleFormat = SampleFormat::PCM16;
+    else if (tag == kPcmTag && bits == 24)
+        format.sampleFormat = SampleFormat::PCM24;
+    else if (tag == kPcmTag && bits == 32)
+        format.sampleFormat = SampleFormat::PCM32;
+    else if (tag == kFloatTag && bits == 32)
+        format.sampleFormat = SampleFormat::FLOAT32;
+    else
+        return false;
+
+    format.channels = channels;
+    format.sampleRate = sampleRate;
+    return channels > 0 && blockAlign == format.frameBytes();
+}
+
+} // namespace
+
+size_t bytes_per_sample(const SampleFormat format) noexcept
+{
+    switch (format) {
+        case SampleFormat::PCM16:
+            return 2;
+        case SampleFormat::PCM24:
+            return 3;
+        case SampleFormat::PCM32:
+        case SampleFormat::FLOAT32:
+            return 4;
+    }
+    return 2;
+}
+
+bool parse_wav(const ByteSource& read, const uint64_t fileSize, WavLayout& layout)
+{
+    unsigned char riff[12];
+    if (fileSize < sizeof(riff) || !read(0, riff, sizeof(riff)))
+        return false;
+
+    const bool rf64 = std::memcmp(riff, "RF64", 4) == 0;
+    if ((!rf64 && std::memcmp(riff, "RIFF", 4) != 0) || std::memcmp(riff + 8, "WAVE", 4) != 0)
+        return false;
+
+    bool hasFormat = false;
+    uint64_t ds64DataSize = 0;
+
+    for (uint64_t offset = sizeof(riff); offset + kChunkHeaderSize <= fileSize;) {
+        unsigned char chunk[kChunkHeaderSize];
+        if (!read(offset, chunk, sizeof(chunk)))
+            return false;
+
+        const uint32_t size = load<uint32_t>(chunk + 4);
+        const uint64_t payload = offset + kChunkHeaderSize;
+
+        if (std::memcmp(chunk, "ds64", 4) == 0 && size >= 16) {
+            unsigned char sizes[16];
+            if (!read(payload, sizes, sizeof(sizes)))
+                return false;
+            ds64DataSize = load<uint64_t>(sizes + 8);
+        } else if (std::memcmp(chunk, "fmt ", 4) == 0) {
+            unsigned char fmt[kExtensibleFormatSize]{};
+            const size_t count = std::min<size_t>(size, sizeof(fmt));
+            if (!read(payload, fmt, count) || !parse_format(fmt, count, layout.format))
+                return false;
+            hasFormat = true;
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (!hasFormat)
+                return false;
+            const uint64_t declared = rf64 && size == kUnknownSize ? ds64DataSize : size;
+            const uint64_t available = std::min(declared, fileSize - payload);
+            layout.dataOffset = payload;
+            layout.dataSize = available / layout.format.frameBytes() * layout.format.frameBytes();
+            layout.rf64 = rf64;
+            return true;
+        }
+
+        offset = payload + size + (size & 1);
+    }
+
+    return false;
+}
+
+bool parse_wav(std::istream& stream, WavLayout& layout)
+{
+    stream.clear();
+    stream.seekg(0, std::ios::end);
+    const auto end = stream.tellg();
+    if (end < 0)
+        return false;
+
+    const ByteSource read = [&stream](const uint64_t offset, void *destination, const size_t count) {
+        stream.seekg(static_cast<std::streamoff>(offset));
+        return static_cast<bool>(stream.read(static_cast<char *>(destination), static_cast<std::streamsize>(count)));
+    };
+
+    const bool ok = parse_wav(read, static_cast<uint64_t>(end), layout);
+    stream.clear();
+    return ok;
+}
+
+bool parse_wav(std::span<const unsigned char> bytes, WavLayout& layout)
+{
+    const ByteSource read = [bytes](const uint64_t offset, void *destination, const size_t count) {
+        if (offset > bytes.size() || count > bytes.size() - offset)
+            return false;
+        std::memcpy(destination, bytes.data() + offset, count);
+        return true;
+    };
+
+    return parse_wav(read, bytes.size(), layout);
+}
+
+std::vector<char> make_wav_header(const WavFormat& format, const uint64_t dataSize)
+{
+    const auto bits = static_cast<uint16_t>(8 * bytes_per_sample(format.sampleFormat));
+    const bool isFloat = format.sampleFormat == SampleFormat::FLOAT32;
+    const bool extensible = format.channels > 2 || format.sampleFormat != SampleFormat::PCM16;
+    const size_t formatSize = extensible ? kExtensibleFormatSize : kPlainFormatSize;
+
+    const size_t headerSize = 12 + (kChunkHeaderSize + kDs64Size) + (kChunkHeaderSize + formatSize) + kChunkHeaderSize;
+    const uint64_t riffSize = headerSize - 8 + dataSize + (dataSize & 1);
+    const bool rf64 = riffSize > kUnknownSize;
+
+    std::vector<char> header;
+    header.reserve(headerSize);
+
+    put_id(header, rf64 ? "RF64" : "RIFF");
+    put<uint32_t>(header, rf64 ? kUnknownSize : static_cast<uint32_t>(riffSize));
+    put_id(header, "WAVE");
+
+    put_id(header, rf64 ? "ds64" : "JUNK");
+    put<uint32_t>(header, kDs64Size);
+    put<uint64_t>(header, rf64 ? riffSize : 0);
+    put<uint64_t>(header, rf64 ? dataSize : 0);
+    put<uint64_t>(header, rf64 ? dataSize / format.frameBytes() : 0);
+    put<uint32_t>(header, 0);
+
+    put_id(header, "fmt ");
+    put<uint32_t>(header, static_cast<uint32_t>(formatSize));
+    put<uint16_t>(header, extensible ? kExtensibleTag : kPcmTag);
+    put<uint16_t>(header, static_cast<uint16_t>(format.channels));
+    put<uint32_t>(header, format.sampleRate);
+    put<uint32_t>(header, static_cast<uint32_t>(format.sampleRate * format.frameBytes()));
+    put<uint16_t>(header, static_cast<uint16_t>(format.frameBytes()));
+    put<uint16_t>(header, bits);
+    if (extensible) {
+        put<uint16_t>(header, 22);
+        put<uint16_t>(header, bits);
+        put<uint32_t>(header, 0);
+        put<uint16_t>(header, isFloat ? kFloatTag : kPcmTag);
+        header.insert(header.end(), std::begin(kSubformatTail), std::end(kSubformatTail));
+    }
+
+    put_id(header, "data");
+    put<uint32_t>(header, rf64 ? kUnknownSize : static_cast<uint32_t>(dataSize));
+
+    return header;
+}
+
+void decode_samples(const unsigned char *bytes, const SampleFormat format, std::span<float> out)
+{
+    switch (format) {
+        case SampleFormat::PCM16:
+            int16_to_float(reinterpret_cast<const int16_t *>(bytes), out);
+            break;
+        case SampleFormat::PCM24:
+            int24_to_float(bytes, out);
+            break;
+        case SampleFormat::PCM32:
+            int32_to_float(reinterpret_cast<const int32_t *>(bytes), out);
+            break;
+        case SampleFormat::FLOAT32:
+            std::memcpy(out.data(), bytes, out.size() * sizeof(float));
+            break;
+    }
+}
+
+void encode_samples(std::span<const float> in, const SampleFormat format, unsigned char *bytes)
+{
+    switch (format) {
+        case SampleFormat::PCM16:
+            float_to_int16(in, reinterpret_cast<int16_t *>(bytes));
+            break;
+        case SampleFormat::PCM24:
+            float_to_int24(in, bytes);
+            break;
+        case SampleFormat::PCM32:
+            float_to_int32(in, reinterpret_cast<int32_t *>(bytes));
+            break;
+        case SampleFormat::FLOAT32:
+            std::memcpy(bytes, in.data(), in.size() * sizeof(float));
+            break;
+    }
+}
@@ -0,0 +1,258 @@
+#include "wav_stream.h"
+
+#include <iostream>
+
+WavReader::WavReader(const size_t bufferFrames, const utils::AsyncFile::Backend backend)
+: m_file(backend)
+, m_buffers(kQueueDepth)
+, m_bufferFrames(std::max<size_t>(bufferFrames, 1))
+{}
+
+WavReader::~WavReader()
+{
+    m_file.close();
+}
+
+bool WavReader::open(const std::string& filename)
+{
+    close();
+
+    if (!m_file.open(filename, utils::AsyncFile::Mode::READ)) {
+        std::cerr << "Failed to open file " << filename << std::endl;
+        return false;
+    }
+
+    const auto source = [this](const uint64_t offset, void *destination, const size_t count) {
+        return m_file.read(offset, {static_cast<unsigned char *>(destination), count})
+            && m_file.wait() == static_cast<int64_t>(count);
+    };
+
+    WavLayout layout;
+    if (!parse_wav(source, m_file.size(), layout)) {
+        std::cerr << "Unsupported or invalid WAV file " << filename << std::endl;
+        close();
+        return false;
+    }
+
+    m_format = layout.format;
+    m_dataOffset = layout.dataOffset;
+    m_frames = static_cast<size_t>(layout.frames());
+    for (auto& buffer : m_buffers) {
+        buffer.resize(m_bufferFrames * m_format.frameBytes());
+    }
+
+    return seek(0);
+}
+
+void WavReader::close()
+{
+    m_file.close();
+
+    m_format = {};
+    m_dataOffset = 0;
+    m_frames = 0;
+    m_position = 0;
+    m_current = 0;
+    m_blockFrames = 0;
+    m_blockOffset = 0;
+    m_ahead = 0;
+}
+
+bool WavReader::seek(const size_t frame)
+{
+    if (!isOpen() || frame > m_frames)
+        return false;
+
+    drain();
+    m_position = frame;
+    m_ahead = frame;
+    m_blockFrames = 0;
+    m_blockOffset = 0;
+
+    return readAhead();
+}
+
+size_t WavReader::read(std::span<float> out)
+{
+    if (!isOpen())
+        return 0;
+
+    const size_t channels = m_format.channels;
+    const size_t frameBytes = m_format.frameBytes();
+    const size_t wanted = std::min(out.size() / channels, m_frames - m_position);
+    size_t done = 0;
+    while (done < wanted) {
+        if (m_blockOffset == m_blockFrames) {
+            const int64_t bytes = m_file.pending() > 0 ? m_file.wait() : -1;
+            if (bytes < static_cast<int64_t>(frameBytes)) {
+                std::cerr << "Failed to read WAV data" << std::endl;
+                m_position += done;
+                static_cast<void>(seek(m_position));
+                return done;
+            }
+
+            // The block just used is free again: queue the next read into it.
+            m_current = (m_current + 1) % m_buffers.size();
+            m_blockFrames = static_cast<size_t>(bytes) / frameBytes;
+            m_blockOffset = 0;
+            readAhead();
+        }
+
+        const size_t count = std::min(wanted - done, m_blockFrames - m_blockOffset);
+        decode_samples(m_buffers[m_current].data() + m_blockOffset * frameBytes, m_format.sampleFormat,
+                       out.subspan(done * channels, count * channels));
+        m_blockOffset += count;
+        done += count;
+    }
+
+    m_position += done;
+    return done;
+}
+
+// Keeps every buffer but the current one busy with the blocks that follow.
+bool WavReader::readAhead()
+{
+    const size_t frameBytes = m_format.frameBytes();
+    while (m_file.pending() + 1 < m_buffers.size() && m_ahead < m_frames) {
+        const size_t slot = (m_current + 1 + m_file.pending()) % m_buffers.size();
+        const size_t count = std::min(m_bufferFrames, m_frames - m_ahead);
+        if (!m_file.read(m_dataOffset + m_ahead * frameBytes, std::span(m_buffers[slot]).first(count * frameBytes)))
+            return false;
+        m_ahead += count;
+    }
+
+    return true;
+}
+
+void WavReader::drain()
+{
+    while (m_file.pending() > 0) {
+        m_file.wait();
+    }
+}
+
+WavWriter::WavWriter(const unsigned int sampleRate, const unsigned int channels, const SampleFormat format,
+                     const size_t bufferFrames, const utils::AsyncFile::Backend backend)
+: m_file(backend)
+, m_format{format, std::max(channels, 1u), sampleRate}
+, m_buffers(kQueueDepth, std::vector<unsigned char>(std::max<size_t>(bufferFrames, 1) * m_format.frameBytes()))
+{}
+
+WavWriter::~WavWriter()
+{
+    if (isOpen() && !close())
+        std::cerr << "Failed to finalize WAV file." << std::endl;
+}
+
+bool WavWriter::open(const std::string& filename)
+{
+    if (isOpen() && !close())
+        return false;
+
+    if (!m_file.open(filename, utils::AsyncFile::Mode::WRITE)) {
+        std::cerr << "Failed to open file " << filename << std::endl;
+        return false;
+    }
+
+    const auto header = make_wav_header(m_format);
+    m_dataOffset = header.size();
+    m_current = 0;
+    m_pending = 0;
+    m_frames = 0;
+    m_position = 0;
+    m_failed = false;
+
+    return writeNow(0, {reinterpret_cast<const unsigned char *>(header.data()), header.size()});
+}
+
+bool WavWriter::close()
+{
+    if (!isOpen())
+        return false;
+
+    bool ok = flush() && drain();
+
+    const uint64_t dataSize = static_cast<uint64_t>(m_frames) * m_format.frameBytes();
+    if (dataSize % 2) {
+        constexpr unsigned char pad{ 0 };
+        ok = writeNow(m_dataOffset + dataSize, {&pad, 1}) && ok;
+    }
+
+    const auto header = make_wav_header(m_format, dataSize);
+    ok = writeNow(0, {reinterpret_cast<const unsigned char *>(header.data()), header.size()}) && ok;
+
+    m_file.close();
+    return ok;
+}
+
+bool WavWriter::write(std::span<const float> data)
+{
+    if (!isOpen())
+        return false;
+
+    const size_t bytesPerSample = bytes_per_sample(m_format.sampleFormat);
+    const size_t capacity = m_buffers[m_current].size() / bytesPerSample;
+    while (!data.empty()) {
+        const size_t count = std::min(data.size(), capacity - m_pending);
+        encode_samples(data.first(count), m_format.sampleFormat,
+                       m_buffers[m_current].data() + m_pending * bytesPerSample);
+        m_pending += count;
+        data = data.subspan(count);
+
+        if (m_pending == capacity && !flush())
+            return false;
+    }
+
+    return true;
+}
+
+// Writes may complete in any order, so none may be in flight when an
+// earlier part of the file is about to be rewritten.
+bool WavWriter::seek(const size_t frame)
+{
+    if (!isOpen() || !flush() || !drain() || frame > m_frames)
+        return false;
+
+    m_position = frame;
+    return true;
+}
+
+// Queues the current buffer and moves on to the next one, waiting for the
+// write that still holds it.
+bool WavWriter::flush()
+{
+    if (m_pending == 0)
+        return !m_failed;
+
+    const size_t bytes = m_pending * bytes_per_sample(m_format.sampleFormat);
+    const uint64_t offset = m_dataOffset + static_cast<uint64_t>(m_position) * m_format.frameBytes();
+    if (!m_file.write(offset, std::span(m_buffers[m_current]).first(bytes)))
+        m_failed = true;
+
+    m_position += m_pending / m_format.channels;
+    m_frames = std::max(m_frames, m_position);
+    m_pending = 0;
+    m_current = (m_current + 1) % m_buffers.size();
+
+    while (m_file.pending() >= m_buffers.size()) {
+        if (m_file.wait() < 0)
+            m_failed = true;
+    }
+
+    return !m_failed;
+}
+
+bool WavWriter::drain()
+{
+    while (m_file.pending() > 0) {
+        if (m_file.wait() < 0)
+            m_failed = true;
+    }
+
+    return !m_failed;
+}
+
+bool WavWriter::writeNow(const uint64_t offset, std::span<const unsigned char> bytes)
+{
+    return drain() && m_file.write(offset, bytes) && m_file.wait() == static_cast<int64_t>(bytes.size());
+}
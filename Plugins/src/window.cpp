@@ -0,0 +1,63 @@
+#include "window.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace utils {
+
+namespace {
+
+// Zeroth-order modified Bessel function of the first kind, by its power
+// series; terms fall off quickly for the beta values used in practice.
+double bessel_i0(const double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 64 && term > 1e-12 * sum; ++k) {
+        const double factor = x / (2.0 * k);
+        term *= factor * factor;
+        sum += term;
+    }
+    return sum;
+}
+
+} // namespace
+
+std::vector<float> make_window(const WindowType type, const size_t size, const bool periodic, const float beta)
+{
+    std::vector<float> window(size, 1.f);
+    if (size < 2)
+        return window;
+
+    const double length = static_cast<double>(periodic ? size : size - 1);
+    const double scale = type == WindowType::KAISER ? 1.0 / bessel_i0(beta) : 1.0;
+
+    for (size_t n = 0; n < size; ++n) {
+        const double phase = 2.0 * std::numbers::pi * static_cast<double>(n) / length;
+        double value = 1.0;
+        switch (type) {
+            case WindowType::RECTANGULAR:
+                break;
+            case WindowType::HANN:
+                value = 0.5 - 0.5 * std::cos(phase);
+                break;
+            case WindowType::HAMMING:
+                value = 0.54 - 0.46 * std::cos(phase);
+                break;
+            case WindowType::BLACKMAN:
+                value = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+                break;
+            case WindowType::KAISER: {
+                const double ratio = 2.0 * static_cast<double>(n) / length - 1.0;
+                value = bessel_i0(beta * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) * scale;
+                break;
+            }
+        }
+        window[n] = static_cast<float>(value);
+    }
+
+    return window;
+}
+
+} // namespace utils
@@ -0,0 +1,149 @@
+#include <fft_plan.h>
+
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <numbers>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    using fourier::complex;
+    using fourier::FftPlan;
+    using fourier::RealFftPlan;
+    using fourier::SimdLevel;
+
+    constexpr double kTolerance{ 1e-6 };
+
+    // Double-precision DFT with exactly reduced angles; inverse is unscaled.
+    std::vector<std::complex<double>> referenceDft(const std::vector<complex>& in, const bool inverse) {
+        const size_t size = in.size();
+        const double sign = inverse ? 1.0 : -1.0;
+        std::vector<std::complex<double>> out(size);
+        for (size_t k = 0; k < size; ++k) {
+            std::complex<double> sum;
+            for (size_t n = 0; n < size; ++n) {
+                const double angle = sign * 2.0 * std::numbers::pi * static_cast<double>(n * k % size) / static_cast<double>(size);
+                sum += std::complex<double>(in[n]) * std::polar(1.0, angle);
+            }
+            out[k] = sum;
+        }
+        return out;
+    }
+
+    // L2 error of out relative to the L2 norm of ref.
+    template<typename T>
+    double relativeError(const std::vector<T>& out, const std::vector<std::complex<double>>& ref) {
+        double error = 0.0;
+        double norm = 0.0;
+        for (size_t i = 0; i < ref.size(); ++i) {
+            error += std::norm(std::complex<double>(out[i]) - ref[i]);
+            norm += std::norm(ref[i]);
+        }
+        return norm > 0.0 ? std::sqrt(error / norm) : std::sqrt(error);
+    }
+
+    std::vector<complex> randomSignal(const size_t size, std::mt19937& random) {
+        std::uniform_real_distribution<float> value(-1.f, 1.f);
+        std::vector<complex> signal(size);
+        for (auto& sample : signal)
+            sample = {value(random), value(random)};
+        return signal;
+    }
+
+    bool report(const std::string& name, const size_t size, const SimdLevel simd, const double error) {
+        if (error <= kTolerance)
+            return true;
+        std::cerr << name << " of " << size << " points at level " << static_cast<int>(simd)
+                  << ": relative error " << error << std::endl;
+        return false;
+    }
+
+    bool checkComplex(const size_t size, const SimdLevel simd, std::mt19937& random) {
+        const auto signal = randomSignal(size, random);
+        FftPlan plan(size, simd);
+
+        std::vector<complex> out(size);
+        plan.execute(signal, out);
+        bool ok = report("FftPlan", size, simd, relativeError(out, referenceDft(signal, false)));
+
+        plan.executeInverse(signal, out);
+        ok = report("FftPlan inverse", size, simd, relativeError(out, referenceDft(signal, true))) && ok;
+        return ok;
+    }
+
+    bool checkReal(const size_t size, const SimdLevel simd, std::mt19937& random) {
+        auto signal = randomSignal(size, random);
+        for (auto& sample : signal)
+            sample.imag(0.f);
+
+        std::vector<float> samples(size);
+        for (size_t i = 0; i < size; ++i)
+            samples[i] = signal[i].real();
+
+        RealFftPlan plan(size, simd);
+        std::vector<complex> spectrum(plan.bins());
+        plan.execute(samples, spectrum);
+
+        auto reference = referenceDft(signal, false);
+        reference.resize(plan.bins());
+        bool ok = report("RealFftPlan", size, simd, relativeError(spectrum, reference));
+
+        // Unscaled inverse of the exact half spectrum gives size * input.
+        std::vector<complex> half(reference.begin(), reference.end());
+        std::vector<float> back(size);
+        plan.executeInverse(half, back);
+
+        std::vector<std::complex<double>> scaled(size);
+        for (size_t i = 0; i < size; ++i)
+            scaled[i] = static_cast<double>(size) * static_cast<double>(samples[i]);
+        ok = report("RealFftPlan inverse", size, simd, relativeError(back, scaled)) && ok;
+        return ok;
+    }
+}
+
+int main() {
+    std::mt19937 random(2024);
+    int failures = 0;
+
+    const SimdLevel levels[] = {SimdLevel::SCALAR, fourier::best_simd_level()};
+
+    // Powers of two, radix-3/5/7 mixes and sizes left to Bluestein.
+    const size_t sizes[] = {
+        1, 2, 4, 8, 16, 64, 512, 4096,
+        3, 5, 7, 15, 105, 448, 1680, 3 * 5 * 7 * 32,
+        11, 17, 97, 286, 1009, 2 * 3 * 641,
+    };
+
+    for (const auto simd : levels) {
+        for (const size_t size : sizes) {
+            if (!checkComplex(size, simd, random))
+                ++failures;
+        }
+
+        for (const size_t size : {2u, 16u, 1000u, 1023u, 1024u, 4095u, 4096u}) {
+            if (!checkReal(size, simd, random))
+                ++failures;
+        }
+    }
+
+    // Four-step: lower the threshold so reference-sized plans take that path.
+    const size_t threshold = fourier::four_step_threshold();
+    fourier::set_four_step_threshold(256);
+    for (const auto simd : levels) {
+        for (const size_t size : {1024u, 4096u}) {
+            if (!FftPlan(size, simd).isFourStep()) {
+                std::cerr << "FftPlan of " << size << " points did not use four-step" << std::endl;
+                ++failures;
+            }
+            if (!checkComplex(size, simd, random))
+                ++failures;
+        }
+        if (!checkReal(4096, simd, random))
+            ++failures;
+    }
+    fourier::set_four_step_threshold(threshold);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+#include <wav_stream.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr size_t kBufferFrames{ 1 << 20 };
+    constexpr size_t kFrames{ kBufferFrames * 6 };
+
+    bool writeFile(const std::string& filename) {
+        WavWriter writer(48000, 1, SampleFormat::PCM16);
+        if (!writer.open(filename))
+            return false;
+
+        std::vector<float> block(4096);
+        for (size_t frame = 0; frame < kFrames; frame += block.size()) {
+            for (size_t i = 0; i < block.size(); ++i)
+                block[i] = static_cast<float>((frame + i) % 1000) / 1000.f - 0.5f;
+            if (!writer.write(block))
+                return false;
+        }
+        return writer.close();
+    }
+
+    // Destroys readers with reads still queued: right after open(), and
+    // part way through the file. Under ASan a reader that frees its buffers
+    // before the transfers drain reports a use-after-free here.
+    bool destroyMidFile(const std::string& filename, const utils::AsyncFile::Backend backend) {
+        {
+            WavReader reader(kBufferFrames, backend);
+            if (!reader.open(filename))
+                return false;
+        }
+
+        {
+            WavReader reader(kBufferFrames, backend);
+            if (!reader.open(filename))
+                return false;
+
+            std::vector<float> out(kBufferFrames + 123);
+            if (reader.read(out) != out.size())
+                return false;
+        }
+
+        WavReader reader(kBufferFrames, backend);
+        if (!reader.open(filename))
+            return false;
+
+        std::vector<float> out(kFrames);
+        return reader.read(out) == kFrames;
+    }
+}
+
+int main() {
+    const auto filename = (std::filesystem::temp_directory_path() / "wav_stream_test.wav").string();
+    if (!writeFile(filename)) {
+        std::cerr << "Failed to write " << filename << std::endl;
+        return 1;
+    }
+
+    int failures = 0;
+    for (const auto backend : {utils::AsyncFile::Backend::THREAD, utils::AsyncFile::Backend::AUTO}) {
+        if (!destroyMidFile(filename, backend)) {
+            std::cerr << "Destroying a reader mid-file failed for backend "
+                      << static_cast<int>(backend) << std::endl;
+            ++failures;
+        }
+    }
+
+    std::remove(filename.c_str());
+    return failures == 0 ? 0 : 1;
+}